@@ -10,321 +10,5538 @@
 #include <iostream>
 #include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <type_traits>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <exception>
+#include <stdexcept>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <cstring>
+#include <cstdio>
+#include <cstddef>
+#include <iterator>
+#include <functional>
+#include <deque>
+#include <memory>
+#include <condition_variable>
+#include <chrono>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 using namespace std;
 
 const int MAX_VECTOR_SIZE = 100000000;
 const int MAX_MATRIX_SIZE = 10000;
 
-// Динамический вектор - 
-// шаблонный вектор на динамической памяти
-template<typename T>
-class TDynamicVector
+// Ограничения размеров, проверяемые конструкторами. По умолчанию вектор
+// содержит не более MAX_VECTOR_SIZE элементов, матрица - не более
+// MAX_MATRIX_SIZE * MAX_MATRIX_SIZE; значение SIZE_MAX снимает ограничение
+namespace tmatrix_detail
 {
-protected:
-  size_t sz;
-  T* pMem;
-public:
-  TDynamicVector(size_t size = 1) : sz(size)
+  inline std::atomic<size_t>& maxVectorSize() noexcept
   {
-    if (sz == 0)
-      throw out_of_range("Vector size should be greater than zero");
-    if (sz > MAX_VECTOR_SIZE) throw out_of_range("Too much importance");
-    pMem = new T[sz]();// {}; // У типа T д.б. конструктор по умолчанию
-    if (pMem == nullptr) throw domain_error("domain_error");
+      static std::atomic<size_t> limit(MAX_VECTOR_SIZE);
+      return limit;
   }
 
-  TDynamicVector(T* arr, size_t s) : sz(s)
+  inline std::atomic<size_t>& maxMatrixElements() noexcept
   {
-    assert(arr != nullptr && "TDynamicVector ctor requires non-nullptr arg");
-    pMem = new T[sz];
-    if (pMem == nullptr) throw domain_error("domain_error");
-    std::copy(arr, arr + sz, pMem);
+      static std::atomic<size_t> limit(size_t(MAX_MATRIX_SIZE) * MAX_MATRIX_SIZE);
+      return limit;
   }
+}
 
-  TDynamicVector(const TDynamicVector& v)
+inline size_t getMaxVectorSize() noexcept
+{
+  return tmatrix_detail::maxVectorSize().load();
+}
+
+inline void setMaxVectorSize(size_t n) noexcept
+{
+  tmatrix_detail::maxVectorSize() = n;
+}
+
+inline size_t getMaxMatrixElements() noexcept
+{
+  return tmatrix_detail::maxMatrixElements().load();
+}
+
+inline void setMaxMatrixElements(size_t n) noexcept
+{
+  tmatrix_detail::maxMatrixElements() = n;
+}
+
+// Ошибка выделения памяти под элементы; сохраняет запрошенный объём
+class TAllocationError : public std::bad_alloc
+{
+  size_t requested;
+  char message[64];
+public:
+  explicit TAllocationError(size_t bytes) noexcept : requested(bytes)
   {
-      sz = v.sz;
-      pMem = new T[sz];
-      if (pMem == nullptr) 
-          throw domain_error("domain error");
-      for (int i = 0; i < sz; i++)
-          pMem[i] = v.pMem[i];
+      std::snprintf(message, sizeof(message), "cannot allocate %llu bytes", (unsigned long long)bytes);
   }
 
-  TDynamicVector(TDynamicVector&& v) noexcept
+  size_t bytes() const noexcept { return requested; }
+  const char* what() const noexcept override { return message; }
+};
+
+// Размер блока для блочных алгоритмов линейной алгебры
+const size_t MATRIX_BLOCK_SIZE = 64;
+
+// Форматы хранения пониженной точности: IEEE 754 binary16 (THalf) и
+// bfloat16 (TBFloat16). Вычисления с ними ведутся во float: значение
+// неявно преобразуется во float, а результат округляется к ближайшему
+// (при равенстве - к чётному) при записи обратно.
+class THalf
+{
+  uint16_t bits;
+public:
+  THalf() noexcept : bits(0) {}
+  THalf(float f) noexcept : bits(fromFloat(f)) {}
+
+  operator float() const noexcept { return toFloat(bits); }
+
+  uint16_t raw() const noexcept { return bits; }
+  static THalf fromRaw(uint16_t b) noexcept
   {
-      sz = 0;
-      pMem = nullptr;
-      swap(*this, v);
+      THalf h;
+      h.bits = b;
+      return h;
   }
 
-  ~TDynamicVector()
+  THalf& operator+=(float v) noexcept { return *this = float(*this) + v; }
+  THalf& operator-=(float v) noexcept { return *this = float(*this) - v; }
+  THalf& operator*=(float v) noexcept { return *this = float(*this) * v; }
+  THalf& operator/=(float v) noexcept { return *this = float(*this) / v; }
+
+  static float toFloat(uint16_t h) noexcept
   {
-      delete[] pMem;
-      pMem = nullptr;
+      const uint32_t shiftedExp = 0x7c00u << 13;
+      uint32_t o = (uint32_t(h) & 0x7fffu) << 13;
+      const uint32_t exp = o & shiftedExp;
+      o += (127u - 15u) << 23;
+      float f;
+      if (exp == shiftedExp)
+          o += (128u - 16u) << 23; // Inf/NaN
+      else if (exp == 0)
+      {
+          // денормализованное: нормализуем через вычитание во float
+          const uint32_t magicBits = 113u << 23;
+          float magic;
+          o += 1u << 23;
+          std::memcpy(&f, &o, sizeof(f));
+          std::memcpy(&magic, &magicBits, sizeof(magic));
+          f -= magic;
+          std::memcpy(&o, &f, sizeof(o));
+      }
+      o |= (uint32_t(h) & 0x8000u) << 16;
+      std::memcpy(&f, &o, sizeof(f));
+      return f;
   }
 
-  TDynamicVector& operator=(const TDynamicVector& v)
+  static uint16_t fromFloat(float value) noexcept
   {
-      if (this == &v)
-          return *this;
-      if (sz != v.sz)
+      const uint32_t infBits = 255u << 23, halfMax = (127u + 16u) << 23;
+      const uint32_t denormMagicBits = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+      uint32_t u;
+      std::memcpy(&u, &value, sizeof(u));
+      const uint32_t sign = u & 0x80000000u;
+      u ^= sign;
+      uint16_t o;
+      if (u >= halfMax)
+          o = u > infBits ? 0x7e00 : 0x7c00; // NaN или переполнение в Inf
+      else if (u < (113u << 23))
       {
-          T* p = new T[v.sz];
-          delete[] pMem;
-          sz = v.sz;
-          pMem = p;
+          // результат денормализован: округление выполняет сложение во float
+          float f, magic;
+          std::memcpy(&f, &u, sizeof(f));
+          std::memcpy(&magic, &denormMagicBits, sizeof(magic));
+          f += magic;
+          std::memcpy(&u, &f, sizeof(u));
+          o = uint16_t(u - denormMagicBits);
+      }
+      else
+      {
+          const uint32_t mantissaOdd = (u >> 13) & 1u;
+          u += ((15u - 127u) << 23) + 0xfffu + mantissaOdd;
+          o = uint16_t(u >> 13);
       }
+      return uint16_t(o | (sign >> 16));
+  }
 
-      std::copy(v.pMem, v.pMem + sz, pMem);
-      return *this;
+  friend ostream& operator<<(ostream& ostr, THalf h)
+  {
+      return ostr << float(h);
   }
+  friend istream& operator>>(istream& istr, THalf& h)
+  {
+      float f;
+      if (istr >> f)
+          h = f;
+      return istr;
+  }
+};
 
-  TDynamicVector& operator=(TDynamicVector&& v) noexcept
+class TBFloat16
+{
+  uint16_t bits;
+public:
+  TBFloat16() noexcept : bits(0) {}
+  TBFloat16(float f) noexcept : bits(fromFloat(f)) {}
+
+  operator float() const noexcept { return toFloat(bits); }
+
+  uint16_t raw() const noexcept { return bits; }
+  static TBFloat16 fromRaw(uint16_t b) noexcept
   {
-      sz = 0;
-      delete[] pMem;
-      pMem = nullptr;
-      swap(*this, v);
-      return (*this);
+      TBFloat16 h;
+      h.bits = b;
+      return h;
   }
 
-  size_t size() const noexcept { return sz; }
+  TBFloat16& operator+=(float v) noexcept { return *this = float(*this) + v; }
+  TBFloat16& operator-=(float v) noexcept { return *this = float(*this) - v; }
+  TBFloat16& operator*=(float v) noexcept { return *this = float(*this) * v; }
+  TBFloat16& operator/=(float v) noexcept { return *this = float(*this) / v; }
 
-  // индексация
-  T& operator[](size_t ind)
+  static float toFloat(uint16_t h) noexcept
   {
-      return pMem[ind];
+      const uint32_t u = uint32_t(h) << 16;
+      float f;
+      std::memcpy(&f, &u, sizeof(f));
+      return f;
   }
 
-  const T& operator[](size_t ind) const
+  static uint16_t fromFloat(float value) noexcept
   {
-      return pMem[ind];
+      uint32_t u;
+      std::memcpy(&u, &value, sizeof(u));
+      if ((u & 0x7fffffffu) > 0x7f800000u)
+          return uint16_t((u >> 16) | 0x40u); // NaN остаётся NaN
+      u += 0x7fffu + ((u >> 16) & 1u);
+      return uint16_t(u >> 16);
   }
-  // индексация с контролем
-  T& at(size_t ind)
+
+  friend ostream& operator<<(ostream& ostr, TBFloat16 h)
   {
-      if (ind < 0 || ind >= sz)
-      {
-          throw range_error("range error");
-      }
-      return pMem[ind];
+      return ostr << float(h);
   }
-  const T& at(size_t ind) const
+  friend istream& operator>>(istream& istr, TBFloat16& h)
   {
-      if (ind < 0 || ind >= sz)
-      {
-          throw range_error("range error");
-      }
-      return pMem[ind];
+      float f;
+      if (istr >> f)
+          h = f;
+      return istr;
   }
+};
 
-  // сравнение
-  bool operator==(const TDynamicVector& v) const noexcept
+namespace tmatrix_detail
+{
+  // тип, в котором накапливаются суммы произведений элементов типа T
+  template<typename T>
+  struct TAccumulator
   {
-      if (sz != v.sz)
-          return false;
-      for (int i = 0; i < sz; i++)
-          if (pMem[i] != v.pMem[i])
-              return false;
-      return true;
-  }
+    typedef T type;
+  };
 
-  bool operator!=(const TDynamicVector& v) const noexcept
+  template<>
+  struct TAccumulator<THalf>
   {
-      return !(*this == v);
-  }
+    typedef float type;
+  };
 
-  // скалярные операции
-  TDynamicVector operator+(T val)
+  template<>
+  struct TAccumulator<TBFloat16>
   {
-      TDynamicVector res(*this);
-      for (int i = 0; i < sz; i++)
-          res.pMem[i] += val;
-      return res;
+    typedef float type;
+  };
+
+  // признак формата хранения, вычисления для которого ведутся в другом типе
+  template<typename T>
+  struct TIsReducedPrecision : std::integral_constant<bool,
+      !std::is_same<typename TAccumulator<T>::type, T>::value>
+  {
+  };
+}
+
+// Служебные средства многопоточного исполнения вычислительных ядер
+namespace tmatrix_detail
+{
+  inline std::atomic<size_t>& threadCount()
+  {
+      static std::atomic<size_t> count(std::max<size_t>(1, std::thread::hardware_concurrency()));
+      return count;
   }
 
-  TDynamicVector operator-(T val)
+  inline std::atomic<bool>& threadPinning()
   {
-      TDynamicVector res(*this);
-      for (int i = 0; i < sz; i++)
-          res.pMem[i] -= val;
-      return res;
+      static std::atomic<bool> pinning(false);
+      return pinning;
   }
 
-  TDynamicVector operator*(T val)
+  // закрепление текущего потока за ядром core; false, если не поддерживается
+  inline bool pinCurrentThread(size_t core)
   {
-      TDynamicVector res(*this);
-      for (int i = 0; i < sz; i++)
-          res.pMem[i] *= val;
-      return res;
+#if defined(__linux__)
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      CPU_SET(int(core % CPU_SETSIZE), &set);
+      return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+      (void)core;
+      return false;
+#endif
   }
 
-  // векторные операции
-  TDynamicVector operator+(const TDynamicVector& v)
+  // Пул потоков с захватом работы: у каждого рабочего потока своя очередь,
+  // свои задачи он берёт с конца, чужие - с начала. Поток, ожидающий
+  // завершения параллельного цикла, сам выполняет задачи из очередей,
+  // поэтому вложенные циклы не порождают новых потоков и не блокируют пул.
+  class TThreadPool
   {
-      if (sz != v.sz)
-          throw length_error("length error");
+    struct TQueue
+    {
+      std::mutex lock;
+      std::deque<std::function<void()>> tasks;
+    };
 
-      TDynamicVector res(*this);
-      for (int i = 0; i < sz; i++)
-          res.pMem[i] += v.pMem[i];
+    std::vector<std::unique_ptr<TQueue>> queues;
+    std::vector<std::thread> threads;
+    std::mutex sleepLock;
+    std::condition_variable wake;
+    std::atomic<size_t> pending;
+    std::atomic<size_t> nextQueue;
+    bool stop;
 
-      return res;
-  }
+    // номер рабочего потока пула, -1 для остальных потоков
+    static int& workerIndex()
+    {
+        static thread_local int index = -1;
+        return index;
+    }
 
-  TDynamicVector operator-(const TDynamicVector& v)
-  {
-      if (sz != v.sz)
-          throw length_error("length error");
+    bool take(std::function<void()>& task)
+    {
+        const int self = workerIndex();
+        if (self >= 0)
+        {
+            TQueue& own = *queues[size_t(self)];
+            std::lock_guard<std::mutex> guard(own.lock);
+            if (!own.tasks.empty())
+            {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                pending--;
+                return true;
+            }
+        }
+        const size_t count = queues.size();
+        const size_t start = self >= 0 ? size_t(self) + 1 : nextQueue.load(std::memory_order_relaxed);
+        for (size_t k = 0; k < count; k++)
+        {
+            TQueue& q = *queues[(start + k) % count];
+            std::lock_guard<std::mutex> guard(q.lock);
+            if (!q.tasks.empty())
+            {
+                task = std::move(q.tasks.front());
+                q.tasks.pop_front();
+                pending--;
+                return true;
+            }
+        }
+        return false;
+    }
 
-      TDynamicVector res(*this);
-      for (int i = 0; i < sz; i++)
-          res.pMem[i] -= v.pMem[i];
+    void run(size_t index, bool pin)
+    {
+        workerIndex() = int(index);
+        if (pin)
+            pinCurrentThread(index + 1);
+        std::function<void()> task;
+        for (;;)
+        {
+            if (take(task))
+            {
+                task();
+                task = nullptr;
+                continue;
+            }
+            std::unique_lock<std::mutex> guard(sleepLock);
+            wake.wait(guard, [this]() { return stop || pending.load() > 0; });
+            if (stop && pending.load() == 0)
+                return;
+        }
+    }
 
-      return res;
+    void shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> guard(sleepLock);
+            stop = true;
+        }
+        wake.notify_all();
+        for (auto& t : threads)
+            t.join();
+        threads.clear();
+        queues.clear();
+    }
+  public:
+    explicit TThreadPool(size_t workers) : pending(0), nextQueue(0), stop(false)
+    {
+        restart(workers);
+    }
+
+    ~TThreadPool()
+    {
+        shutdown();
+    }
+
+    TThreadPool(const TThreadPool&) = delete;
+    TThreadPool& operator=(const TThreadPool&) = delete;
+
+    // пересоздание рабочих потоков; допустимо только вне параллельных циклов
+    void restart(size_t workers)
+    {
+        shutdown();
+        stop = false;
+        const bool pin = threadPinning().load();
+        for (size_t i = 0; i < workers; i++)
+            queues.emplace_back(new TQueue);
+        for (size_t i = 0; i < workers; i++)
+            threads.emplace_back(&TThreadPool::run, this, i, pin);
+    }
+
+    size_t size() const noexcept { return threads.size(); }
+
+    void submit(std::function<void()> task)
+    {
+        const int self = workerIndex();
+        const size_t q = self >= 0 ? size_t(self) : nextQueue++ % queues.size();
+        {
+            std::lock_guard<std::mutex> guard(queues[q]->lock);
+            queues[q]->tasks.push_back(std::move(task));
+        }
+        pending++;
+        {
+            std::lock_guard<std::mutex> guard(sleepLock);
+        }
+        wake.notify_one();
+    }
+
+    // выполнить одну задачу из очередей пула; false, если задач нет
+    bool runOne()
+    {
+        std::function<void()> task;
+        if (!take(task))
+            return false;
+        task();
+        return true;
+    }
+  };
+
+  inline TThreadPool& threadPool()
+  {
+      static TThreadPool pool(threadCount().load() - 1);
+      return pool;
   }
 
-  T operator*(const TDynamicVector& v) 
+  // Параллельный цикл по [first, last): диапазон режется на куски по grain
+  // элементов, куски раздаются потокам пула динамически; f(begin, end).
+  // Вложенные циклы тоже выполняются в пуле
+  template<typename F>
+  void parallelFor(size_t first, size_t last, size_t grain, F f)
   {
-      if (sz != v.sz) throw length_error("length error");
-      T sum = T(); 
-      for (size_t i = 0; i < sz; ++i) 
-          sum += (pMem[i] * v.pMem[i]);
-      return sum;
+      if (first >= last)
+          return;
+      if (grain == 0)
+          grain = 1;
+      const size_t chunks = (last - first + grain - 1) / grain;
+      const size_t workers = std::min(threadCount().load(), chunks);
+      if (workers <= 1 || threadPool().size() == 0)
+      {
+          f(first, last);
+          return;
+      }
 
+      // состояние цикла живёт, пока на него ссылаются задачи в очередях
+      struct TLoop
+      {
+        std::atomic<size_t> next;
+        std::atomic<size_t> done;
+        std::exception_ptr error;
+        std::mutex errorMutex;
+
+        TLoop() : next(0), done(0) {}
+      };
+      std::shared_ptr<TLoop> loop = std::make_shared<TLoop>();
+      F* pf = &f;
+      auto body = [loop, pf, first, last, grain, chunks]()
+      {
+          for (size_t c = loop->next++; c < chunks; c = loop->next++)
+          {
+              const size_t begin = first + c * grain;
+              try
+              {
+                  (*pf)(begin, std::min(begin + grain, last));
+              }
+              catch (...)
+              {
+                  {
+                      std::lock_guard<std::mutex> guard(loop->errorMutex);
+                      if (!loop->error)
+                          loop->error = std::current_exception();
+                  }
+                  // невыданные куски считаются выполненными
+                  const size_t claimed = loop->next.exchange(chunks);
+                  if (claimed < chunks)
+                      loop->done += chunks - claimed;
+              }
+              loop->done++;
+          }
+      };
+
+      TThreadPool& pool = threadPool();
+      for (size_t w = 1; w < workers; w++)
+          pool.submit(body);
+      body();
+      while (loop->done.load() < chunks)
+          if (!pool.runOne())
+              std::this_thread::yield();
+      if (loop->error)
+          std::rethrow_exception(loop->error);
   }
 
-  friend void swap(TDynamicVector& lhs, TDynamicVector& rhs) noexcept
+  // копирование n элементов: для тривиально копируемых типов - memcpy
+  template<typename T>
+  void copyElements(const T* src, size_t n, T* dst, std::true_type) noexcept
   {
-    std::swap(lhs.sz, rhs.sz);
-    std::swap(lhs.pMem, rhs.pMem);
+      if (n != 0)
+          std::memcpy(dst, src, n * sizeof(T));
   }
 
-  // ввод/вывод
-  friend istream& operator>>(istream& istr, TDynamicVector& v)
+  template<typename T>
+  void copyElements(const T* src, size_t n, T* dst, std::false_type)
   {
-    for (size_t i = 0; i < v.sz; i++)
-      istr >> v.pMem[i]; // требуется оператор>> для типа T
-    return istr;
+      std::copy(src, src + n, dst);
   }
-  friend ostream& operator<<(ostream& ostr, const TDynamicVector& v)
+
+  template<typename T>
+  void copyElements(const T* src, size_t n, T* dst)
   {
-    for (size_t i = 0; i < v.sz; i++)
-      ostr << v.pMem[i] << ' '; // требуется оператор<< для типа T
-    return ostr;
+      copyElements(src, n, dst, std::integral_constant<bool, std::is_trivially_copyable<T>::value>());
   }
-};
 
-
-// Динамическая матрица - 
-// шаблонная матрица на динамической памяти
-template<typename T>
-class TDynamicMatrix : private TDynamicVector<TDynamicVector<T>>
-{
-  using TDynamicVector<TDynamicVector<T>>::pMem;
-  using TDynamicVector<TDynamicVector<T>>::sz;
-public:
-  TDynamicMatrix(size_t s = 1) : TDynamicVector<TDynamicVector<T>>(s)
+  // поэлементное сравнение: memcmp допустим только для целых типов,
+  // у вещественных +0 == -0 и NaN != NaN
+  template<typename T>
+  bool equalElements(const T* a, const T* b, size_t n, std::true_type) noexcept
   {
-      if (sz > MAX_MATRIX_SIZE) 
-          throw out_of_range("out_of_range");
-      if (sz == 0) 
-          throw out_of_range("out_of_range");
-      for (size_t i = 0; i < sz; i++)
-      pMem[i] = TDynamicVector<T>(sz);
+      return n == 0 || std::memcmp(a, b, n * sizeof(T)) == 0;
   }
 
-  using TDynamicVector<TDynamicVector<T>>::operator[];
-  using TDynamicVector<TDynamicVector<T> >::at;
-  size_t size() const noexcept { return sz; }
-
-  // сравнение
-  bool operator==(const TDynamicMatrix& m) const noexcept
+  template<typename T>
+  bool equalElements(const T* a, const T* b, size_t n, std::false_type)
   {
-      if (sz != m.sz)
-          return false;
-      for (int i = 0; i < sz; i++)
-          if (pMem[i] != m.pMem[i])
+      for (size_t i = 0; i < n; i++)
+          if (a[i] != b[i])
               return false;
       return true;
   }
 
-  bool operator!=(const TDynamicMatrix& m) const noexcept
+  template<typename T>
+  bool equalElements(const T* a, const T* b, size_t n)
   {
-      return !(*this == m);
+      return equalElements(a, b, n, std::is_integral<T>());
   }
 
-  // матрично-скалярные операции
-  TDynamicMatrix operator*(const T& val)
+  // скалярное произведение с несколькими аккумуляторами
+  template<typename T>
+  T dot(const T* x, const T* y, size_t n) noexcept
   {
-      TDynamicMatrix res(sz);
-      for (int i = 0; i < sz; i++)
-          res.pMem[i] = pMem[i] * val;
-      return res;
+      T s0 = T(), s1 = T(), s2 = T(), s3 = T();
+      size_t i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+          s0 += x[i] * y[i];
+          s1 += x[i + 1] * y[i + 1];
+          s2 += x[i + 2] * y[i + 2];
+          s3 += x[i + 3] * y[i + 3];
+      }
+      for (; i < n; i++)
+          s0 += x[i] * y[i];
+      return (s0 + s1) + (s2 + s3);
   }
 
-  // матрично-векторные операции
-  TDynamicVector<T> operator*(const TDynamicVector<T>& v)
+  // число элементов на поток в поэлементных операциях
+  const size_t elementwiseGrain = 16384;
+
+  // y += alpha * x
+  template<typename T>
+  void axpy(T alpha, const T* x, T* y, size_t n) noexcept
   {
-      if (size() != v.size()) 
-          throw range_error;
+      for (size_t i = 0; i < n; i++)
+          y[i] += alpha * x[i];
+  }
 
-      TDynamicVector<T> res(sz);
-      for (i = 0; i < sz; i++) 
-          for (j = 0; j < sz; j++) 
-              res[i] += pMem[i][j] * v[j];
+  // расширение до float и сужение обратно; циклы без ветвлений по данным
+  // векторизуются компилятором
+  template<typename S>
+  void widen(const S* src, size_t n, float* dst) noexcept
+  {
+      for (size_t i = 0; i < n; i++)
+          dst[i] = float(src[i]);
+  }
 
-      return res;
+  template<typename D>
+  void narrow(const float* src, size_t n, D* dst) noexcept
+  {
+      for (size_t i = 0; i < n; i++)
+          dst[i] = D(src[i]);
+  }
+
+  // скалярное произведение для форматов хранения пониженной точности:
+  // элементы расширяются до float порциями, сумма копится во float
+  template<typename S>
+  float reducedDot(const S* x, const S* y, size_t n) noexcept
+  {
+      const size_t chunk = 256;
+      float xf[chunk], yf[chunk];
+      float s = 0.0f;
+      for (size_t i = 0; i < n; i += chunk)
+      {
+          const size_t len = std::min(chunk, n - i);
+          widen(x + i, len, xf);
+          widen(y + i, len, yf);
+          s += dot(xf, yf, len);
+      }
+      return s;
+  }
 
+  inline float dot(const THalf* x, const THalf* y, size_t n) noexcept
+  {
+      return reducedDot(x, y, n);
   }
 
-  // матрично-матричные операции
-  TDynamicMatrix operator+(const TDynamicMatrix& m)
+  inline float dot(const TBFloat16* x, const TBFloat16* y, size_t n) noexcept
   {
-      if (sz != m.sz)
-          throw length_error("length error");
-      TDynamicMatrix<T> res(sz);
-      for (int i = 0; i < sz; i++)
-          res.pMem[i] = pMem[i] + m.pMem[i];
-      return res;
+      return reducedDot(x, y, n);
   }
-  TDynamicMatrix operator-(const TDynamicMatrix& m)
+
+  template<typename T, typename ARow, typename BRow, typename CRow>
+  void gemmRows(size_t m, size_t n, size_t kn, ARow aRow, BRow bRow, CRow cRow);
+
+  template<typename T, typename ARow, typename BRow, typename CRow>
+  void gemmRows(size_t m, size_t n, size_t kn, ARow aRow, BRow bRow, CRow cRow, std::false_type)
   {
-      if (sz != m.sz)
-          throw length_error("length error");
-      TDynamicMatrix<T> res(sz);
-      for (int i = 0; i < sz; i++)
-          res.pMem[i] = pMem[i] - m.pMem[i];
-      return res;
+      const size_t kBlock = 128, jBlock = 512, rowGrain = 8;
+      parallelFor(0, m, rowGrain, [&](size_t first, size_t last)
+      {
+          for (size_t i = first; i < last; i++)
+              std::fill(cRow(i), cRow(i) + n, T());
+          for (size_t j0 = 0; j0 < n; j0 += jBlock)
+          {
+              const size_t jn = std::min(jBlock, n - j0);
+              for (size_t k0 = 0; k0 < kn; k0 += kBlock)
+              {
+                  const size_t k1 = std::min(k0 + kBlock, kn);
+                  for (size_t i = first; i < last; i++)
+                  {
+                      const T* ai = aRow(i);
+                      T* ci = cRow(i) + j0;
+                      for (size_t k = k0; k < k1; k++)
+                          axpy(ai[k], bRow(k) + j0, ci, jn);
+                  }
+              }
+          }
+      });
   }
-  TDynamicMatrix operator*(const TDynamicMatrix& m)
+
+  // B однократно расширяется до float; строки A и C расширяются в пределах
+  // куска строк, обрабатываемого одним потоком
+  template<typename T, typename ARow, typename BRow, typename CRow>
+  void gemmRows(size_t m, size_t n, size_t kn, ARow aRow, BRow bRow, CRow cRow, std::true_type)
   {
-      if (sz != m.sz)
-          throw length_error("length error");
-      TDynamicMatrix res(sz);
-      for (int i = 0; i < sz; i++)
-          for (int k = 0; k < sz; k++)
-              for (int j = 0; j < sz; j++)
-                  res.pMem[i][j] += pMem[i][k] * m.pMem[k][j];
-      return res;
+      const size_t rowGrain = 8;
+      std::vector<float> bf(kn * n);
+      parallelFor(0, kn, rowGrain, [&](size_t first, size_t last)
+      {
+          for (size_t k = first; k < last; k++)
+              widen(bRow(k), n, bf.data() + k * n);
+      });
+      parallelFor(0, m, rowGrain, [&](size_t first, size_t last)
+      {
+          const size_t rows = last - first;
+          std::vector<float> af(rows * kn), cf(rows * n);
+          for (size_t i = 0; i < rows; i++)
+              widen(aRow(first + i), kn, af.data() + i * kn);
+          gemmRows<float>(rows, n, kn,
+              [&](size_t i) { return af.data() + i * kn; },
+              [&](size_t k) { return bf.data() + k * n; },
+              [&](size_t i) { return cf.data() + i * n; });
+          for (size_t i = 0; i < rows; i++)
+              narrow(cf.data() + i * n, n, cRow(first + i));
+      });
   }
 
-  // ввод/вывод
-  friend istream& operator>>(istream& istr, TDynamicMatrix& v)
+  // C = A * B (m x kn на kn x n) по указателям на строки: aRow(i), bRow(k),
+  // cRow(i) возвращают начало i-й строки. Строки C распределяются между
+  // потоками, внутренние циклы блокируются по k и j; для форматов хранения
+  // пониженной точности накопление ведётся во float
+  template<typename T, typename ARow, typename BRow, typename CRow>
+  void gemmRows(size_t m, size_t n, size_t kn, ARow aRow, BRow bRow, CRow cRow)
   {
-      for (int i = 0; i < v.sz; i++) {
-          istr >> v.pMem[i];
-      }
-      return istr;
+      gemmRows<T>(m, n, kn, aRow, bRow, cRow, TIsReducedPrecision<T>());
   }
-  friend ostream& operator<<(ostream& ostr, const TDynamicMatrix& v)
+}
+
+// число потоков, используемых вычислительными ядрами
+inline size_t getNumThreads() noexcept
+{
+  return tmatrix_detail::threadCount().load();
+}
+
+// Изменение числа потоков и закрепления пересоздаёт рабочие потоки пула,
+// поэтому вызывать их можно только вне параллельных вычислений
+inline void setNumThreads(size_t n)
+{
+  tmatrix_detail::threadCount() = std::max<size_t>(1, n);
+  tmatrix_detail::threadPool().restart(tmatrix_detail::threadCount().load() - 1);
+}
+
+// закрепление рабочих потоков пула за ядрами (поток i - за ядром i + 1);
+// возвращает false, если платформа закрепление не поддерживает
+inline bool setThreadPinning(bool enabled)
+{
+#if defined(__linux__)
+  const bool supported = true;
+#else
+  const bool supported = false;
+#endif
+  tmatrix_detail::threadPinning() = enabled && supported;
+  tmatrix_detail::threadPool().restart(tmatrix_detail::threadCount().load() - 1);
+  return supported || !enabled;
+}
+
+inline bool getThreadPinning() noexcept
+{
+  return tmatrix_detail::threadPinning().load();
+}
+
+// Инструментирование операций. Счётчики ведутся, только если при сборке
+// определён макрос TMATRIX_INSTRUMENTATION; без него макросы
+// TMATRIX_OPERATION и TMATRIX_ALLOCATION ничего не порождают, а снимок
+// состоит из нулей.
+enum class TOperation
+{
+  VectorAdd,    // сложение и вычитание векторов и матриц
+  VectorScalar, // операции вектора или матрицы со скаляром
+  Dot,          // скалярное произведение
+  Gemv,         // умножение матрицы на вектор
+  Gemm,         // умножение матриц
+  Copy,         // копирование векторов
+  Io,           // ввод/вывод
+  Other,        // выделения памяти вне перечисленных операций
+  Count
+};
+
+inline const char* operationName(TOperation op) noexcept
+{
+  static const char* const names[] = { "vector_add", "vector_scalar", "dot", "gemv", "gemm", "copy", "io", "other" };
+  return op < TOperation::Count ? names[size_t(op)] : "unknown";
+}
+
+struct TOperationStats
+{
+  uint64_t calls = 0;
+  uint64_t elements = 0;    // обработано элементов
+  uint64_t flops = 0;       // оценка числа операций с плавающей точкой
+  uint64_t bytes = 0;       // оценка объёма прочитанной и записанной памяти
+  uint64_t allocations = 0; // выделений динамической памяти
+  double seconds = 0.0;     // суммарное время выполнения
+};
+
+struct TInstrumentationSnapshot
+{
+  TOperationStats stats[size_t(TOperation::Count)];
+
+  const TOperationStats& operator[](TOperation op) const { return stats[size_t(op)]; }
+
+  friend ostream& operator<<(ostream& ostr, const TInstrumentationSnapshot& s)
   {
-      for (int i = 0; i < v.sz; i++) 
-          ostr << v.pMem[i] << endl;
+      ostr << "operation calls elements flops bytes allocations seconds" << endl;
+      for (size_t i = 0; i < size_t(TOperation::Count); i++)
+      {
+          const TOperationStats& st = s.stats[i];
+          ostr << operationName(TOperation(i)) << ' ' << st.calls << ' ' << st.elements << ' '
+              << st.flops << ' ' << st.bytes << ' ' << st.allocations << ' ' << st.seconds << endl;
+      }
       return ostr;
   }
 };
 
+namespace tmatrix_detail
+{
+  struct TOperationCounters
+  {
+    std::atomic<uint64_t> calls;
+    std::atomic<uint64_t> elements;
+    std::atomic<uint64_t> flops;
+    std::atomic<uint64_t> bytes;
+    std::atomic<uint64_t> allocations;
+    std::atomic<uint64_t> nanoseconds;
+  };
+
+  inline TOperationCounters* operationCounters() noexcept
+  {
+      static TOperationCounters counters[size_t(TOperation::Count)];
+      return counters;
+  }
+
+  // операция, выполняемая текущим потоком; к ней относятся выделения памяти
+  inline TOperation& currentOperation() noexcept
+  {
+      static thread_local TOperation op = TOperation::Other;
+      return op;
+  }
+
+  inline void countAllocation() noexcept
+  {
+      operationCounters()[size_t(currentOperation())].allocations.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // учёт одного вызова операции и его времени до конца области видимости.
+  // Операция, вложенная в другую в том же потоке, не учитывается: её время,
+  // трафик и выделения памяти входят во внешнюю операцию
+  class TOperationScope
+  {
+    TOperation op;
+    TOperation previous;
+    bool nested;
+    std::chrono::steady_clock::time_point start;
+  public:
+    TOperationScope(TOperation o, uint64_t elements, uint64_t flops, uint64_t bytes) noexcept
+        : op(o), previous(currentOperation()), nested(previous != TOperation::Other), start()
+    {
+        if (nested)
+            return;
+        start = std::chrono::steady_clock::now();
+        TOperationCounters& c = operationCounters()[size_t(op)];
+        c.calls.fetch_add(1, std::memory_order_relaxed);
+        c.elements.fetch_add(elements, std::memory_order_relaxed);
+        c.flops.fetch_add(flops, std::memory_order_relaxed);
+        c.bytes.fetch_add(bytes, std::memory_order_relaxed);
+        currentOperation() = op;
+    }
+
+    ~TOperationScope()
+    {
+        if (nested)
+            return;
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        operationCounters()[size_t(op)].nanoseconds.fetch_add(uint64_t(ns.count()), std::memory_order_relaxed);
+        currentOperation() = previous;
+    }
+
+    TOperationScope(const TOperationScope&) = delete;
+    TOperationScope& operator=(const TOperationScope&) = delete;
+  };
+}
+
+#ifdef TMATRIX_INSTRUMENTATION
+#define TMATRIX_OPERATION(op, elements, flops, bytes) \
+  tmatrix_detail::TOperationScope tmatrixOperationScope(op, uint64_t(elements), uint64_t(flops), uint64_t(bytes))
+#define TMATRIX_ALLOCATION() tmatrix_detail::countAllocation()
+#else
+#define TMATRIX_OPERATION(op, elements, flops, bytes) ((void)0)
+#define TMATRIX_ALLOCATION() ((void)0)
+#endif
+
+inline bool instrumentationEnabled() noexcept
+{
+#ifdef TMATRIX_INSTRUMENTATION
+  return true;
+#else
+  return false;
+#endif
+}
+
+inline TInstrumentationSnapshot instrumentationSnapshot() noexcept
+{
+  TInstrumentationSnapshot s;
+  const tmatrix_detail::TOperationCounters* c = tmatrix_detail::operationCounters();
+  for (size_t i = 0; i < size_t(TOperation::Count); i++)
+  {
+      s.stats[i].calls = c[i].calls.load();
+      s.stats[i].elements = c[i].elements.load();
+      s.stats[i].flops = c[i].flops.load();
+      s.stats[i].bytes = c[i].bytes.load();
+      s.stats[i].allocations = c[i].allocations.load();
+      s.stats[i].seconds = double(c[i].nanoseconds.load()) * 1e-9;
+  }
+  return s;
+}
+
+inline void resetInstrumentation() noexcept
+{
+  tmatrix_detail::TOperationCounters* c = tmatrix_detail::operationCounters();
+  for (size_t i = 0; i < size_t(TOperation::Count); i++)
+  {
+      c[i].calls = 0;
+      c[i].elements = 0;
+      c[i].flops = 0;
+      c[i].bytes = 0;
+      c[i].allocations = 0;
+      c[i].nanoseconds = 0;
+  }
+}
+
+// Учёт памяти, занятой векторами и матрицами библиотеки: текущий и
+// пиковый объём, число живых буферов, наибольшие выделения, обработчик
+// событий и запрет выделений в критичных участках
+typedef void (*TAllocationHook)(size_t bytes, bool allocated);
+
+struct TAllocationStats
+{
+  size_t currentBytes = 0;
+  size_t peakBytes = 0;
+  size_t liveBuffers = 0;       // буферов, выделенных и ещё не освобождённых
+  size_t totalAllocations = 0;
+  std::vector<size_t> largest;  // наибольшие выделения с последнего сброса, по убыванию
+};
+
+namespace tmatrix_detail
+{
+  struct TAllocationCounters
+  {
+    static const size_t largestCount = 8;
+
+    std::atomic<size_t> currentBytes;
+    std::atomic<size_t> peakBytes;
+    std::atomic<size_t> liveBuffers;
+    std::atomic<size_t> totalAllocations;
+    std::atomic<TAllocationHook> hook;
+    std::atomic<size_t> largestThreshold; // наименьшее из largest, когда список полон
+    std::mutex largestMutex;
+    size_t largest[largestCount];
+    size_t largestSize;
+  };
+
+  inline TAllocationCounters& allocationCounters() noexcept
+  {
+      static TAllocationCounters counters;
+      return counters;
+  }
+
+  // глубина вложенности участков, где выделения запрещены (в текущем потоке)
+  inline size_t& allocationForbidden() noexcept
+  {
+      static thread_local size_t depth = 0;
+      return depth;
+  }
+
+  inline void recordLargest(TAllocationCounters& c, size_t bytes)
+  {
+      if (bytes <= c.largestThreshold.load(std::memory_order_relaxed))
+          return;
+      std::lock_guard<std::mutex> guard(c.largestMutex);
+      size_t pos = c.largestSize;
+      if (pos == TAllocationCounters::largestCount)
+      {
+          if (bytes <= c.largest[pos - 1])
+              return;
+          pos--;
+      }
+      else
+          c.largestSize++;
+      for (; pos > 0 && c.largest[pos - 1] < bytes; pos--)
+          c.largest[pos] = c.largest[pos - 1];
+      c.largest[pos] = bytes;
+      if (c.largestSize == TAllocationCounters::largestCount)
+          c.largestThreshold = c.largest[c.largestSize - 1];
+  }
+
+  // выделение и освобождение памяти под n элементов с учётом
+  template<typename T>
+  T* allocateElements(size_t n, bool valueInit)
+  {
+      if (allocationForbidden() != 0)
+          throw logic_error("allocation in allocation-free section");
+      if (n > std::numeric_limits<size_t>::max() / sizeof(T))
+          throw TAllocationError(std::numeric_limits<size_t>::max());
+      T* p;
+      try
+      {
+          p = valueInit ? new T[n]() : new T[n];
+      }
+      catch (const TAllocationError&)
+      {
+          throw;
+      }
+      catch (const std::bad_alloc&)
+      {
+          throw TAllocationError(n * sizeof(T));
+      }
+      const size_t bytes = n * sizeof(T);
+      TAllocationCounters& c = allocationCounters();
+      const size_t current = c.currentBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+      size_t peak = c.peakBytes.load(std::memory_order_relaxed);
+      while (current > peak && !c.peakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+      {
+      }
+      c.liveBuffers.fetch_add(1, std::memory_order_relaxed);
+      c.totalAllocations.fetch_add(1, std::memory_order_relaxed);
+      recordLargest(c, bytes);
+      if (TAllocationHook hook = c.hook.load())
+          hook(bytes, true);
+      TMATRIX_ALLOCATION();
+      return p;
+  }
+
+  template<typename T>
+  void releaseElements(T* p, size_t n) noexcept
+  {
+      if (p == nullptr)
+          return;
+      delete[] p;
+      const size_t bytes = n * sizeof(T);
+      TAllocationCounters& c = allocationCounters();
+      c.currentBytes.fetch_sub(bytes, std::memory_order_relaxed);
+      c.liveBuffers.fetch_sub(1, std::memory_order_relaxed);
+      if (TAllocationHook hook = c.hook.load())
+          hook(bytes, false);
+  }
+}
+
+inline TAllocationStats allocationStats()
+{
+  tmatrix_detail::TAllocationCounters& c = tmatrix_detail::allocationCounters();
+  TAllocationStats s;
+  s.currentBytes = c.currentBytes.load();
+  s.peakBytes = c.peakBytes.load();
+  s.liveBuffers = c.liveBuffers.load();
+  s.totalAllocations = c.totalAllocations.load();
+  std::lock_guard<std::mutex> guard(c.largestMutex);
+  s.largest.assign(c.largest, c.largest + c.largestSize);
+  return s;
+}
+
+// пик приравнивается текущему объёму, список наибольших выделений очищается
+inline void resetPeakAllocation()
+{
+  tmatrix_detail::TAllocationCounters& c = tmatrix_detail::allocationCounters();
+  std::lock_guard<std::mutex> guard(c.largestMutex);
+  c.peakBytes = c.currentBytes.load();
+  c.largestSize = 0;
+  c.largestThreshold = 0;
+}
+
+// обработчик вызывается после каждого выделения и освобождения;
+// nullptr отключает его. Возвращает предыдущий обработчик
+inline TAllocationHook setAllocationHook(TAllocationHook hook) noexcept
+{
+  return tmatrix_detail::allocationCounters().hook.exchange(hook);
+}
+
+// Участок без выделений: пока объект существует, любое выделение памяти
+// вектором или матрицей в этом потоке бросает logic_error
+class TNoAllocationScope
+{
+public:
+  TNoAllocationScope() noexcept { tmatrix_detail::allocationForbidden()++; }
+  ~TNoAllocationScope() { tmatrix_detail::allocationForbidden()--; }
+
+  TNoAllocationScope(const TNoAllocationScope&) = delete;
+  TNoAllocationScope& operator=(const TNoAllocationScope&) = delete;
+};
+
+// Динамический вектор - 
+// шаблонный вектор на динамической памяти
+template<typename T>
+class TDynamicVector
+{
+protected:
+  size_t sz;
+  T* pMem;
+
+  // память под результат арифметической операции: без инициализации
+  // и без учёта копирования
+  struct TUninitialized {};
+  TDynamicVector(size_t s, TUninitialized) : sz(s), pMem(tmatrix_detail::allocateElements<T>(s, false))
+  {
+  }
+public:
+  typedef T value_type;
+  typedef size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  // память вектора непрерывна, итераторами служат указатели
+  typedef T* iterator;
+  typedef const T* const_iterator;
+
+  TDynamicVector(size_t size = 1) : sz(size)
+  {
+    if (sz == 0)
+      throw out_of_range("Vector size should be greater than zero");
+    if (sz > getMaxVectorSize()) throw out_of_range("Too much importance");
+    pMem = tmatrix_detail::allocateElements<T>(sz, true); // У типа T д.б. конструктор по умолчанию
+    if (pMem == nullptr) throw domain_error("domain_error");
+  }
+
+  TDynamicVector(const T* arr, size_t s) : sz(s)
+  {
+    assert(arr != nullptr && "TDynamicVector ctor requires non-nullptr arg");
+    if (sz == 0)
+      throw out_of_range("Vector size should be greater than zero");
+    if (sz > getMaxVectorSize()) throw out_of_range("Too much importance");
+    TMATRIX_OPERATION(TOperation::Copy, sz, 0, 2 * sz * sizeof(T));
+    pMem = tmatrix_detail::allocateElements<T>(sz, false);
+    if (pMem == nullptr) throw domain_error("domain_error");
+    tmatrix_detail::copyElements(arr, sz, pMem);
+  }
+
+  TDynamicVector(const TDynamicVector& v)
+  {
+      sz = v.sz;
+      TMATRIX_OPERATION(TOperation::Copy, sz, 0, 2 * sz * sizeof(T));
+      pMem = tmatrix_detail::allocateElements<T>(sz, false);
+      if (pMem == nullptr) 
+          throw domain_error("domain error");
+      tmatrix_detail::copyElements(v.pMem, sz, pMem);
+  }
+
+  TDynamicVector(TDynamicVector&& v) noexcept
+  {
+      sz = 0;
+      pMem = nullptr;
+      swap(*this, v);
+  }
+
+  ~TDynamicVector()
+  {
+      tmatrix_detail::releaseElements(pMem, sz);
+      pMem = nullptr;
+  }
+
+  TDynamicVector& operator=(const TDynamicVector& v)
+  {
+      if (this == &v)
+          return *this;
+      TMATRIX_OPERATION(TOperation::Copy, v.sz, 0, 2 * v.sz * sizeof(T));
+      if (sz != v.sz)
+      {
+          T* p = tmatrix_detail::allocateElements<T>(v.sz, false);
+          tmatrix_detail::releaseElements(pMem, sz);
+          sz = v.sz;
+          pMem = p;
+      }
+
+      tmatrix_detail::copyElements(v.pMem, sz, pMem);
+      return *this;
+  }
+
+  TDynamicVector& operator=(TDynamicVector&& v) noexcept
+  {
+      tmatrix_detail::releaseElements(pMem, sz);
+      sz = 0;
+      pMem = nullptr;
+      swap(*this, v);
+      return (*this);
+  }
+
+  size_t size() const noexcept { return sz; }
+
+  // непосредственный доступ к памяти (для вычислительных ядер)
+  T* data() noexcept { return pMem; }
+  const T* data() const noexcept { return pMem; }
+
+  iterator begin() noexcept { return pMem; }
+  iterator end() noexcept { return pMem + sz; }
+  const_iterator begin() const noexcept { return pMem; }
+  const_iterator end() const noexcept { return pMem + sz; }
+  const_iterator cbegin() const noexcept { return pMem; }
+  const_iterator cend() const noexcept { return pMem + sz; }
+
+  // индексация
+  T& operator[](size_t ind)
+  {
+      return pMem[ind];
+  }
+
+  const T& operator[](size_t ind) const
+  {
+      return pMem[ind];
+  }
+  // индексация с контролем
+  T& at(size_t ind)
+  {
+      if (ind >= sz)
+      {
+          throw range_error("range error");
+      }
+      return pMem[ind];
+  }
+  const T& at(size_t ind) const
+  {
+      if (ind >= sz)
+      {
+          throw range_error("range error");
+      }
+      return pMem[ind];
+  }
+
+  // сравнение
+  bool operator==(const TDynamicVector& v) const noexcept
+  {
+      return sz == v.sz && tmatrix_detail::equalElements(pMem, v.pMem, sz);
+  }
+
+  bool operator!=(const TDynamicVector& v) const noexcept
+  {
+      return !(*this == v);
+  }
+
+  // скалярные операции
+  TDynamicVector operator+(T val)
+  {
+      TMATRIX_OPERATION(TOperation::VectorScalar, sz, sz, 2 * sz * sizeof(T));
+      TDynamicVector res(sz, TUninitialized());
+      for (size_t i = 0; i < sz; i++)
+          res.pMem[i] = pMem[i] + val;
+      return res;
+  }
+
+  TDynamicVector operator-(T val)
+  {
+      TMATRIX_OPERATION(TOperation::VectorScalar, sz, sz, 2 * sz * sizeof(T));
+      TDynamicVector res(sz, TUninitialized());
+      for (size_t i = 0; i < sz; i++)
+          res.pMem[i] = pMem[i] - val;
+      return res;
+  }
+
+  TDynamicVector operator*(T val)
+  {
+      TMATRIX_OPERATION(TOperation::VectorScalar, sz, sz, 2 * sz * sizeof(T));
+      TDynamicVector res(sz, TUninitialized());
+      for (size_t i = 0; i < sz; i++)
+          res.pMem[i] = pMem[i] * val;
+      return res;
+  }
+
+  // векторные операции
+  TDynamicVector operator+(const TDynamicVector& v)
+  {
+      if (sz != v.sz)
+          throw length_error("length error");
+
+      TMATRIX_OPERATION(TOperation::VectorAdd, sz, sz, 3 * sz * sizeof(T));
+      TDynamicVector res(sz, TUninitialized());
+      for (size_t i = 0; i < sz; i++)
+          res.pMem[i] = pMem[i] + v.pMem[i];
+
+      return res;
+  }
+
+  TDynamicVector operator-(const TDynamicVector& v)
+  {
+      if (sz != v.sz)
+          throw length_error("length error");
+
+      TMATRIX_OPERATION(TOperation::VectorAdd, sz, sz, 3 * sz * sizeof(T));
+      TDynamicVector res(sz, TUninitialized());
+      for (size_t i = 0; i < sz; i++)
+          res.pMem[i] = pMem[i] - v.pMem[i];
+
+      return res;
+  }
+
+  T operator*(const TDynamicVector& v) 
+  {
+      if (sz != v.sz) throw length_error("length error");
+      TMATRIX_OPERATION(TOperation::Dot, sz, 2 * sz, 2 * sz * sizeof(T));
+      return T(tmatrix_detail::dot(pMem, v.pMem, sz));
+
+  }
+
+  // Поэлементные операции: map(f) и zip(v, f) возвращают новый вектор,
+  // apply(f) изменяет текущий. Функтор встраивается в цикл по памяти
+  // вектора; большие векторы делятся между потоками, поэтому f может
+  // вызываться одновременно из разных потоков
+  template<typename F>
+  auto map(F f) const -> TDynamicVector<typename std::decay<decltype(f(std::declval<const T&>()))>::type>
+  {
+      typedef typename std::decay<decltype(f(std::declval<const T&>()))>::type R;
+      TDynamicVector<R> res(sz);
+      R* r = res.data();
+      const T* x = pMem;
+      tmatrix_detail::parallelFor(0, sz, tmatrix_detail::elementwiseGrain, [&f, r, x](size_t first, size_t last)
+      {
+          for (size_t i = first; i < last; i++)
+              r[i] = f(x[i]);
+      });
+      return res;
+  }
+
+  template<typename U, typename F>
+  auto zip(const TDynamicVector<U>& v, F f) const
+      -> TDynamicVector<typename std::decay<decltype(f(std::declval<const T&>(), std::declval<const U&>()))>::type>
+  {
+      typedef typename std::decay<decltype(f(std::declval<const T&>(), std::declval<const U&>()))>::type R;
+      if (sz != v.size())
+          throw length_error("length error");
+      TDynamicVector<R> res(sz);
+      R* r = res.data();
+      const T* x = pMem;
+      const U* y = v.data();
+      tmatrix_detail::parallelFor(0, sz, tmatrix_detail::elementwiseGrain, [&f, r, x, y](size_t first, size_t last)
+      {
+          for (size_t i = first; i < last; i++)
+              r[i] = f(x[i], y[i]);
+      });
+      return res;
+  }
+
+  template<typename F>
+  TDynamicVector& apply(F f)
+  {
+      T* x = pMem;
+      tmatrix_detail::parallelFor(0, sz, tmatrix_detail::elementwiseGrain, [&f, x](size_t first, size_t last)
+      {
+          for (size_t i = first; i < last; i++)
+              x[i] = f(x[i]);
+      });
+      return *this;
+  }
+
+  friend void swap(TDynamicVector& lhs, TDynamicVector& rhs) noexcept
+  {
+    std::swap(lhs.sz, rhs.sz);
+    std::swap(lhs.pMem, rhs.pMem);
+  }
+
+  // ввод/вывод
+  friend istream& operator>>(istream& istr, TDynamicVector& v)
+  {
+    TMATRIX_OPERATION(TOperation::Io, v.sz, 0, v.sz * sizeof(T));
+    for (size_t i = 0; i < v.sz; i++)
+      istr >> v.pMem[i]; // требуется оператор>> для типа T
+    return istr;
+  }
+  friend ostream& operator<<(ostream& ostr, const TDynamicVector& v)
+  {
+    TMATRIX_OPERATION(TOperation::Io, v.sz, 0, v.sz * sizeof(T));
+    for (size_t i = 0; i < v.sz; i++)
+      ostr << v.pMem[i] << ' '; // требуется оператор<< для типа T
+    return ostr;
+  }
+};
+
+
+template<typename T>
+class TDynamicMatrix;
+
+template<typename T>
+class TMatrixRowView;
+
+template<typename T>
+class TMatrixColumnView;
+
+template<typename T>
+class TMatrixBlockView;
+
+// Итератор произвольного доступа по элементам матрицы в построчном
+// порядке. Строки хранятся отдельными векторами, поэтому итератор хранит
+// указатель на строку и номер столбца; T может быть const
+template<typename T>
+class TMatrixIterator
+{
+  typedef typename std::remove_const<T>::type Value;
+  typedef typename std::conditional<std::is_const<T>::value,
+      const TDynamicVector<Value>, TDynamicVector<Value>>::type Row;
+
+  Row* row;
+  size_t j;
+  size_t n;
+public:
+  typedef std::random_access_iterator_tag iterator_category;
+  typedef Value value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef T* pointer;
+  typedef T& reference;
+
+  TMatrixIterator() noexcept : row(nullptr), j(0), n(1) {}
+  TMatrixIterator(Row* r, size_t column, size_t cols) noexcept : row(r), j(column), n(cols) {}
+
+  // неконстантный итератор приводится к константному
+  operator TMatrixIterator<const Value>() const noexcept { return TMatrixIterator<const Value>(row, j, n); }
+
+  reference operator*() const { return row->data()[j]; }
+  pointer operator->() const { return row->data() + j; }
+  reference operator[](difference_type k) const { return *(*this + k); }
+
+  TMatrixIterator& operator++() noexcept
+  {
+      if (++j == n)
+      {
+          j = 0;
+          ++row;
+      }
+      return *this;
+  }
+  TMatrixIterator operator++(int) noexcept
+  {
+      TMatrixIterator t(*this);
+      ++*this;
+      return t;
+  }
+  TMatrixIterator& operator--() noexcept
+  {
+      if (j == 0)
+      {
+          j = n;
+          --row;
+      }
+      --j;
+      return *this;
+  }
+  TMatrixIterator operator--(int) noexcept
+  {
+      TMatrixIterator t(*this);
+      --*this;
+      return t;
+  }
+
+  TMatrixIterator& operator+=(difference_type k) noexcept
+  {
+      const difference_type cols = difference_type(n);
+      difference_type pos = difference_type(j) + k;
+      difference_type q = pos / cols, r = pos % cols;
+      if (r < 0)
+      {
+          r += cols;
+          q--;
+      }
+      row += q;
+      j = size_t(r);
+      return *this;
+  }
+  TMatrixIterator& operator-=(difference_type k) noexcept { return *this += -k; }
+
+  friend TMatrixIterator operator+(TMatrixIterator it, difference_type k) noexcept { return it += k; }
+  friend TMatrixIterator operator+(difference_type k, TMatrixIterator it) noexcept { return it += k; }
+  friend TMatrixIterator operator-(TMatrixIterator it, difference_type k) noexcept { return it -= k; }
+
+  friend difference_type operator-(const TMatrixIterator& a, const TMatrixIterator& b) noexcept
+  {
+      return (a.row - b.row) * difference_type(a.n) + (difference_type(a.j) - difference_type(b.j));
+  }
+
+  friend bool operator==(const TMatrixIterator& a, const TMatrixIterator& b) noexcept { return a.row == b.row && a.j == b.j; }
+  friend bool operator!=(const TMatrixIterator& a, const TMatrixIterator& b) noexcept { return !(a == b); }
+  friend bool operator<(const TMatrixIterator& a, const TMatrixIterator& b) noexcept
+  {
+      return a.row < b.row || (a.row == b.row && a.j < b.j);
+  }
+  friend bool operator>(const TMatrixIterator& a, const TMatrixIterator& b) noexcept { return b < a; }
+  friend bool operator<=(const TMatrixIterator& a, const TMatrixIterator& b) noexcept { return !(b < a); }
+  friend bool operator>=(const TMatrixIterator& a, const TMatrixIterator& b) noexcept { return !(a < b); }
+};
+
+template<typename T>
+void multiply(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b, TDynamicMatrix<T>& c);
+
+template<typename T>
+void multiply(const TDynamicMatrix<T>& a, const TDynamicVector<T>& x, TDynamicVector<T>& y);
+
+// Способ обращения матрицы
+enum class TInversionMethod
+{
+  LU,         // LU-разложение и обращение треугольных множителей
+  GaussJordan // метод Гаусса-Жордана с выбором ведущего элемента
+};
+
+namespace tmatrix_detail
+{
+  template<typename T>
+  void invertLU(TDynamicMatrix<T>& a);
+
+  template<typename T>
+  void invertGaussJordan(TDynamicMatrix<T>& a);
+}
+
+// Динамическая матрица - 
+// шаблонная матрица на динамической памяти.
+// Матрица rows x cols хранится построчно; число элементов ограничено
+// getMaxMatrixElements()
+template<typename T>
+class TDynamicMatrix : private TDynamicVector<TDynamicVector<T>>
+{
+  using TDynamicVector<TDynamicVector<T>>::pMem;
+  using TDynamicVector<TDynamicVector<T>>::sz;
+  size_t columns;
+
+  // число строк на поток в поэлементных операциях
+  size_t rowGrain() const noexcept
+  {
+      return std::max<size_t>(1, tmatrix_detail::elementwiseGrain / columns);
+  }
+public:
+  TDynamicMatrix(size_t s = 1) : TDynamicMatrix(s, s)
+  {
+  }
+
+  TDynamicMatrix(size_t rows, size_t cols) : TDynamicVector<TDynamicVector<T>>(rows), columns(cols)
+  {
+      if (columns == 0) 
+          throw out_of_range("out_of_range");
+      if (columns > getMaxVectorSize() || sz > getMaxMatrixElements() / columns)
+          throw out_of_range("out_of_range");
+      for (size_t i = 0; i < sz; i++)
+          pMem[i] = TDynamicVector<T>(columns);
+  }
+
+  using TDynamicVector<TDynamicVector<T>>::operator[];
+  using TDynamicVector<TDynamicVector<T> >::at;
+  // size() - число строк
+  size_t size() const noexcept { return sz; }
+  size_t rows() const noexcept { return sz; }
+  size_t cols() const noexcept { return columns; }
+
+  typedef T value_type;
+  typedef TMatrixIterator<T> iterator;
+  typedef TMatrixIterator<const T> const_iterator;
+  typedef TDynamicVector<T>* row_iterator;
+  typedef const TDynamicVector<T>* const_row_iterator;
+
+  // обход всех элементов в построчном порядке
+  iterator begin() noexcept { return iterator(pMem, 0, columns); }
+  iterator end() noexcept { return iterator(pMem + sz, 0, columns); }
+  const_iterator begin() const noexcept { return const_iterator(pMem, 0, columns); }
+  const_iterator end() const noexcept { return const_iterator(pMem + sz, 0, columns); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  // обход строк
+  row_iterator rowsBegin() noexcept { return pMem; }
+  row_iterator rowsEnd() noexcept { return pMem + sz; }
+  const_row_iterator rowsBegin() const noexcept { return pMem; }
+  const_row_iterator rowsEnd() const noexcept { return pMem + sz; }
+
+  // представления без копирования: блок h x w с левым верхним углом (r, c),
+  // строка i и столбец j
+  TMatrixBlockView<T> block(size_t r, size_t c, size_t h, size_t w)
+  {
+      if (r + h > sz || c + w > columns || h == 0 || w == 0)
+          throw out_of_range("out_of_range");
+      return TMatrixBlockView<T>(pMem + r, c, h, w);
+  }
+  TMatrixBlockView<const T> block(size_t r, size_t c, size_t h, size_t w) const
+  {
+      if (r + h > sz || c + w > columns || h == 0 || w == 0)
+          throw out_of_range("out_of_range");
+      return TMatrixBlockView<const T>(pMem + r, c, h, w);
+  }
+  TMatrixRowView<T> row(size_t i)
+  {
+      if (i >= sz)
+          throw out_of_range("out_of_range");
+      return TMatrixRowView<T>(pMem[i].data(), columns);
+  }
+  TMatrixRowView<const T> row(size_t i) const
+  {
+      if (i >= sz)
+          throw out_of_range("out_of_range");
+      return TMatrixRowView<const T>(pMem[i].data(), columns);
+  }
+  TMatrixColumnView<T> col(size_t j)
+  {
+      if (j >= columns)
+          throw out_of_range("out_of_range");
+      return TMatrixColumnView<T>(pMem, j, sz);
+  }
+  TMatrixColumnView<const T> col(size_t j) const
+  {
+      if (j >= columns)
+          throw out_of_range("out_of_range");
+      return TMatrixColumnView<const T>(pMem, j, sz);
+  }
+
+  // транспонирование, блоками для локальности обращений
+  TDynamicMatrix transpose() const
+  {
+      const size_t tile = 32;
+      TDynamicMatrix res(columns, sz);
+      tmatrix_detail::parallelFor(0, columns, tile, [&](size_t c0, size_t c1)
+      {
+          for (size_t i0 = 0; i0 < sz; i0 += tile)
+          {
+              const size_t i1 = std::min(i0 + tile, sz);
+              for (size_t j = c0; j < c1; j++)
+              {
+                  T* rj = res.pMem[j].data();
+                  for (size_t i = i0; i < i1; i++)
+                      rj[i] = pMem[i][j];
+              }
+          }
+      });
+      return res;
+  }
+
+  // сравнение
+  bool operator==(const TDynamicMatrix& m) const noexcept
+  {
+      if (sz != m.sz || columns != m.columns)
+          return false;
+      for (size_t i = 0; i < sz; i++)
+          if (pMem[i] != m.pMem[i])
+              return false;
+      return true;
+  }
+
+  bool operator!=(const TDynamicMatrix& m) const noexcept
+  {
+      return !(*this == m);
+  }
+
+  // матрично-скалярные операции
+  TDynamicMatrix operator*(const T& val)
+  {
+      TMATRIX_OPERATION(TOperation::VectorScalar, sz * columns, sz * columns, 2 * sz * columns * sizeof(T));
+      TDynamicMatrix res(sz, columns);
+      for (size_t i = 0; i < sz; i++)
+      {
+          T* r = res.pMem[i].data();
+          const T* x = pMem[i].data();
+          for (size_t j = 0; j < columns; j++)
+              r[j] = x[j] * val;
+      }
+      return res;
+  }
+
+  // матрично-векторные операции
+  TDynamicVector<T> operator*(const TDynamicVector<T>& v)
+  {
+      if (columns != v.size()) 
+          throw length_error("length error");
+
+      TDynamicVector<T> res(sz);
+      multiply(*this, v, res);
+      return res;
+  }
+
+  // матрично-матричные операции
+  TDynamicMatrix operator+(const TDynamicMatrix& m)
+  {
+      if (sz != m.sz || columns != m.columns)
+          throw length_error("length error");
+      TMATRIX_OPERATION(TOperation::VectorAdd, sz * columns, sz * columns, 3 * sz * columns * sizeof(T));
+      TDynamicMatrix<T> res(sz, columns);
+      for (size_t i = 0; i < sz; i++)
+      {
+          T* r = res.pMem[i].data();
+          const T* x = pMem[i].data();
+          const T* y = m.pMem[i].data();
+          for (size_t j = 0; j < columns; j++)
+              r[j] = x[j] + y[j];
+      }
+      return res;
+  }
+  TDynamicMatrix operator-(const TDynamicMatrix& m)
+  {
+      if (sz != m.sz || columns != m.columns)
+          throw length_error("length error");
+      TMATRIX_OPERATION(TOperation::VectorAdd, sz * columns, sz * columns, 3 * sz * columns * sizeof(T));
+      TDynamicMatrix<T> res(sz, columns);
+      for (size_t i = 0; i < sz; i++)
+      {
+          T* r = res.pMem[i].data();
+          const T* x = pMem[i].data();
+          const T* y = m.pMem[i].data();
+          for (size_t j = 0; j < columns; j++)
+              r[j] = x[j] - y[j];
+      }
+      return res;
+  }
+  TDynamicMatrix operator*(const TDynamicMatrix& m)
+  {
+      if (columns != m.sz)
+          throw length_error("length error");
+      TDynamicMatrix res(sz, m.columns);
+      multiply(*this, m, res);
+      return res;
+  }
+
+  // поэлементные операции, аналогичные TDynamicVector::map, zip и apply;
+  // между потоками делятся строки
+  template<typename F>
+  auto map(F f) const -> TDynamicMatrix<typename std::decay<decltype(f(std::declval<const T&>()))>::type>
+  {
+      typedef typename std::decay<decltype(f(std::declval<const T&>()))>::type R;
+      TDynamicMatrix<R> res(sz, columns);
+      const size_t n = columns;
+      tmatrix_detail::parallelFor(0, sz, rowGrain(), [&](size_t first, size_t last)
+      {
+          for (size_t i = first; i < last; i++)
+          {
+              R* r = res[i].data();
+              const T* x = pMem[i].data();
+              for (size_t j = 0; j < n; j++)
+                  r[j] = f(x[j]);
+          }
+      });
+      return res;
+  }
+
+  template<typename U, typename F>
+  auto zip(const TDynamicMatrix<U>& m, F f) const
+      -> TDynamicMatrix<typename std::decay<decltype(f(std::declval<const T&>(), std::declval<const U&>()))>::type>
+  {
+      typedef typename std::decay<decltype(f(std::declval<const T&>(), std::declval<const U&>()))>::type R;
+      if (sz != m.rows() || columns != m.cols())
+          throw length_error("length error");
+      TDynamicMatrix<R> res(sz, columns);
+      const size_t n = columns;
+      tmatrix_detail::parallelFor(0, sz, rowGrain(), [&](size_t first, size_t last)
+      {
+          for (size_t i = first; i < last; i++)
+          {
+              R* r = res[i].data();
+              const T* x = pMem[i].data();
+              const U* y = m[i].data();
+              for (size_t j = 0; j < n; j++)
+                  r[j] = f(x[j], y[j]);
+          }
+      });
+      return res;
+  }
+
+  template<typename F>
+  TDynamicMatrix& apply(F f)
+  {
+      const size_t n = columns;
+      tmatrix_detail::parallelFor(0, sz, rowGrain(), [&](size_t first, size_t last)
+      {
+          for (size_t i = first; i < last; i++)
+          {
+              T* x = pMem[i].data();
+              for (size_t j = 0; j < n; j++)
+                  x[j] = f(x[j]);
+          }
+      });
+      return *this;
+  }
+
+  // обращение на месте, требует O(n) дополнительной памяти
+  void invertInPlace(TInversionMethod method = TInversionMethod::LU)
+  {
+      if (method == TInversionMethod::LU)
+          tmatrix_detail::invertLU(*this);
+      else
+          tmatrix_detail::invertGaussJordan(*this);
+  }
+
+  TDynamicMatrix inverse(TInversionMethod method = TInversionMethod::LU) const
+  {
+      TDynamicMatrix res(*this);
+      res.invertInPlace(method);
+      return res;
+  }
+
+  friend void swap(TDynamicMatrix& lhs, TDynamicMatrix& rhs) noexcept
+  {
+      swap(static_cast<TDynamicVector<TDynamicVector<T>>&>(lhs),
+          static_cast<TDynamicVector<TDynamicVector<T>>&>(rhs));
+      std::swap(lhs.columns, rhs.columns);
+  }
+
+  // ввод/вывод
+  friend istream& operator>>(istream& istr, TDynamicMatrix& v)
+  {
+      for (size_t i = 0; i < v.sz; i++) {
+          istr >> v.pMem[i];
+      }
+      return istr;
+  }
+  friend ostream& operator<<(ostream& ostr, const TDynamicMatrix& v)
+  {
+      for (size_t i = 0; i < v.sz; i++) 
+          ostr << v.pMem[i] << endl;
+      return ostr;
+  }
+};
+
+namespace tmatrix_detail
+{
+  // строка матрицы с сохранением константности элементов
+  template<typename T>
+  struct TRowType
+  {
+      typedef TDynamicVector<T> type;
+  };
+
+  template<typename T>
+  struct TRowType<const T>
+  {
+      typedef const TDynamicVector<T> type;
+  };
+
+  template<typename V>
+  struct TIsVectorView : std::false_type {};
+  template<typename T>
+  struct TIsVectorView<TMatrixRowView<T>> : std::true_type {};
+  template<typename T>
+  struct TIsVectorView<TMatrixColumnView<T>> : std::true_type {};
+
+  template<typename V>
+  struct TIsVectorLike : TIsVectorView<V> {};
+  template<typename T>
+  struct TIsVectorLike<TDynamicVector<T>> : std::true_type {};
+
+  template<typename M>
+  struct TIsMatrixView : std::false_type {};
+  template<typename T>
+  struct TIsMatrixView<TMatrixBlockView<T>> : std::true_type {};
+
+  template<typename M>
+  struct TIsMatrixLike : TIsMatrixView<M> {};
+  template<typename T>
+  struct TIsMatrixLike<TDynamicMatrix<T>> : std::true_type {};
+
+  // операнды вида "вектор/представление", хотя бы один - представление
+  template<typename A, typename B>
+  struct TVectorViewOperands
+      : std::integral_constant<bool, TIsVectorLike<A>::value && TIsVectorLike<B>::value &&
+          (TIsVectorView<A>::value || TIsVectorView<B>::value)> {};
+
+  template<typename A, typename B>
+  struct TMatrixViewOperands
+      : std::integral_constant<bool, TIsMatrixLike<A>::value && TIsMatrixLike<B>::value &&
+          (TIsMatrixView<A>::value || TIsMatrixView<B>::value)> {};
+
+  // поэлементные операции над векторами и представлениями
+  template<typename D, typename S>
+  void assignElements(const D& dst, const S& src)
+  {
+      if (dst.size() != src.size())
+          throw length_error("length error");
+      for (size_t i = 0; i < dst.size(); i++)
+          dst[i] = src[i];
+  }
+
+  template<typename D, typename S>
+  void addElements(const D& dst, const S& src, bool subtract)
+  {
+      if (dst.size() != src.size())
+          throw length_error("length error");
+      for (size_t i = 0; i < dst.size(); i++)
+          if (subtract)
+              dst[i] -= src[i];
+          else
+              dst[i] += src[i];
+  }
+
+  template<typename A, typename B>
+  TDynamicVector<typename A::value_type> combineElements(const A& a, const B& b, bool subtract)
+  {
+      if (a.size() != b.size())
+          throw length_error("length error");
+      TDynamicVector<typename A::value_type> res(a.size());
+      for (size_t i = 0; i < a.size(); i++)
+          res[i] = subtract ? a[i] - b[i] : a[i] + b[i];
+      return res;
+  }
+
+  // начало i-й строки матрицы или блока
+  template<typename T>
+  const T* rowPointer(const TDynamicMatrix<T>& m, size_t i) { return m[i].data(); }
+  template<typename T>
+  const typename std::remove_const<T>::type* rowPointer(const TMatrixBlockView<T>& m, size_t i) { return m.row(i).data(); }
+}
+
+// Представление непрерывного участка строки матрицы (без владения памятью).
+// Копирование представления не копирует данные; присваивание копирует
+// элементы в строку. Для T = const U представление доступно только для чтения.
+template<typename T>
+class TMatrixRowView
+{
+  T* pMem;
+  size_t sz;
+public:
+  typedef typename std::remove_const<T>::type value_type;
+
+  TMatrixRowView(T* p, size_t n) : pMem(p), sz(n) {}
+  TMatrixRowView(const TMatrixRowView& v) = default;
+  template<typename U, typename = typename std::enable_if<std::is_same<const U, T>::value>::type>
+  TMatrixRowView(const TMatrixRowView<U>& v) : pMem(v.data()), sz(v.size()) {}
+
+  size_t size() const noexcept { return sz; }
+  T* data() const noexcept { return pMem; }
+
+  T& operator[](size_t ind) const { return pMem[ind]; }
+  T& at(size_t ind) const
+  {
+      if (ind >= sz)
+          throw range_error("range error");
+      return pMem[ind];
+  }
+
+  TDynamicVector<value_type> toVector() const { return TDynamicVector<value_type>(pMem, sz); }
+
+  TMatrixRowView& operator=(const TMatrixRowView& v)
+  {
+      tmatrix_detail::assignElements(*this, v);
+      return *this;
+  }
+  template<typename V>
+  typename std::enable_if<tmatrix_detail::TIsVectorLike<V>::value, TMatrixRowView&>::type
+  operator=(const V& v)
+  {
+      tmatrix_detail::assignElements(*this, v);
+      return *this;
+  }
+  TMatrixRowView& operator=(const value_type& val)
+  {
+      std::fill(pMem, pMem + sz, val);
+      return *this;
+  }
+
+  template<typename V>
+  typename std::enable_if<tmatrix_detail::TIsVectorLike<V>::value, TMatrixRowView&>::type
+  operator+=(const V& v)
+  {
+      tmatrix_detail::addElements(*this, v, false);
+      return *this;
+  }
+  template<typename V>
+  typename std::enable_if<tmatrix_detail::TIsVectorLike<V>::value, TMatrixRowView&>::type
+  operator-=(const V& v)
+  {
+      tmatrix_detail::addElements(*this, v, true);
+      return *this;
+  }
+  TMatrixRowView& operator+=(const value_type& val)
+  {
+      for (size_t i = 0; i < sz; i++)
+          pMem[i] += val;
+      return *this;
+  }
+  TMatrixRowView& operator-=(const value_type& val)
+  {
+      for (size_t i = 0; i < sz; i++)
+          pMem[i] -= val;
+      return *this;
+  }
+  TMatrixRowView& operator*=(const value_type& val)
+  {
+      for (size_t i = 0; i < sz; i++)
+          pMem[i] *= val;
+      return *this;
+  }
+};
+
+// Представление столбца (или его участка): шаг между элементами - строка матрицы
+template<typename T>
+class TMatrixColumnView
+{
+  typedef typename tmatrix_detail::TRowType<T>::type Row;
+  Row* pRows;
+  size_t column;
+  size_t sz;
+public:
+  typedef typename std::remove_const<T>::type value_type;
+
+  TMatrixColumnView(Row* rows, size_t col, size_t n) : pRows(rows), column(col), sz(n) {}
+  TMatrixColumnView(const TMatrixColumnView& v) = default;
+  template<typename U, typename = typename std::enable_if<std::is_same<const U, T>::value>::type>
+  TMatrixColumnView(const TMatrixColumnView<U>& v) : pRows(v.rowsBegin()), column(v.index()), sz(v.size()) {}
+
+  size_t size() const noexcept { return sz; }
+  size_t index() const noexcept { return column; }
+  Row* rowsBegin() const noexcept { return pRows; }
+
+  T& operator[](size_t ind) const { return pRows[ind][column]; }
+  T& at(size_t ind) const
+  {
+      if (ind >= sz)
+          throw range_error("range error");
+      return pRows[ind][column];
+  }
+
+  TDynamicVector<value_type> toVector() const
+  {
+      TDynamicVector<value_type> res(sz);
+      for (size_t i = 0; i < sz; i++)
+          res[i] = pRows[i][column];
+      return res;
+  }
+
+  TMatrixColumnView& operator=(const TMatrixColumnView& v)
+  {
+      tmatrix_detail::assignElements(*this, v);
+      return *this;
+  }
+  template<typename V>
+  typename std::enable_if<tmatrix_detail::TIsVectorLike<V>::value, TMatrixColumnView&>::type
+  operator=(const V& v)
+  {
+      tmatrix_detail::assignElements(*this, v);
+      return *this;
+  }
+  TMatrixColumnView& operator=(const value_type& val)
+  {
+      for (size_t i = 0; i < sz; i++)
+          pRows[i][column] = val;
+      return *this;
+  }
+
+  template<typename V>
+  typename std::enable_if<tmatrix_detail::TIsVectorLike<V>::value, TMatrixColumnView&>::type
+  operator+=(const V& v)
+  {
+      tmatrix_detail::addElements(*this, v, false);
+      return *this;
+  }
+  template<typename V>
+  typename std::enable_if<tmatrix_detail::TIsVectorLike<V>::value, TMatrixColumnView&>::type
+  operator-=(const V& v)
+  {
+      tmatrix_detail::addElements(*this, v, true);
+      return *this;
+  }
+  TMatrixColumnView& operator+=(const value_type& val)
+  {
+      for (size_t i = 0; i < sz; i++)
+          pRows[i][column] += val;
+      return *this;
+  }
+  TMatrixColumnView& operator-=(const value_type& val)
+  {
+      for (size_t i = 0; i < sz; i++)
+          pRows[i][column] -= val;
+      return *this;
+  }
+  TMatrixColumnView& operator*=(const value_type& val)
+  {
+      for (size_t i = 0; i < sz; i++)
+          pRows[i][column] *= val;
+      return *this;
+  }
+};
+
+// Представление прямоугольного блока матрицы
+template<typename T>
+class TMatrixBlockView
+{
+  typedef typename tmatrix_detail::TRowType<T>::type Row;
+  Row* pRows;
+  size_t firstColumn;
+  size_t nRows;
+  size_t nCols;
+
+  template<typename M>
+  void checkShape(const M& m) const
+  {
+      if (m.rows() != nRows || m.cols() != nCols)
+          throw length_error("length error");
+  }
+public:
+  typedef typename std::remove_const<T>::type value_type;
+
+  TMatrixBlockView(Row* rows, size_t col, size_t h, size_t w) : pRows(rows), firstColumn(col), nRows(h), nCols(w) {}
+  TMatrixBlockView(const TMatrixBlockView& v) = default;
+  template<typename U, typename = typename std::enable_if<std::is_same<const U, T>::value>::type>
+  TMatrixBlockView(const TMatrixBlockView<U>& v)
+      : pRows(v.rowsBegin()), firstColumn(v.columnOffset()), nRows(v.rows()), nCols(v.cols()) {}
+
+  size_t rows() const noexcept { return nRows; }
+  size_t cols() const noexcept { return nCols; }
+  size_t columnOffset() const noexcept { return firstColumn; }
+  Row* rowsBegin() const noexcept { return pRows; }
+
+  T& operator()(size_t i, size_t j) const { return pRows[i][firstColumn + j]; }
+  TMatrixRowView<T> operator[](size_t i) const { return row(i); }
+
+  TMatrixRowView<T> row(size_t i) const { return TMatrixRowView<T>(pRows[i].data() + firstColumn, nCols); }
+  TMatrixColumnView<T> col(size_t j) const { return TMatrixColumnView<T>(pRows, firstColumn + j, nRows); }
+  TMatrixBlockView block(size_t r, size_t c, size_t h, size_t w) const
+  {
+      if (r + h > nRows || c + w > nCols || h == 0 || w == 0)
+          throw out_of_range("out_of_range");
+      return TMatrixBlockView(pRows + r, firstColumn + c, h, w);
+  }
+
+  TDynamicMatrix<value_type> toMatrix() const
+  {
+      TDynamicMatrix<value_type> res(nRows, nCols);
+      for (size_t i = 0; i < nRows; i++)
+          std::copy(row(i).data(), row(i).data() + nCols, res[i].data());
+      return res;
+  }
+
+  TMatrixBlockView& operator=(const TMatrixBlockView& m)
+  {
+      return assign(m);
+  }
+  template<typename M>
+  typename std::enable_if<tmatrix_detail::TIsMatrixLike<M>::value, TMatrixBlockView&>::type
+  operator=(const M& m)
+  {
+      return assign(m);
+  }
+  TMatrixBlockView& operator=(const value_type& val)
+  {
+      for (size_t i = 0; i < nRows; i++)
+          row(i) = val;
+      return *this;
+  }
+
+  template<typename M>
+  typename std::enable_if<tmatrix_detail::TIsMatrixLike<M>::value, TMatrixBlockView&>::type
+  operator+=(const M& m)
+  {
+      checkShape(m);
+      for (size_t i = 0; i < nRows; i++)
+          tmatrix_detail::axpy(value_type(1), tmatrix_detail::rowPointer(m, i), row(i).data(), nCols);
+      return *this;
+  }
+  template<typename M>
+  typename std::enable_if<tmatrix_detail::TIsMatrixLike<M>::value, TMatrixBlockView&>::type
+  operator-=(const M& m)
+  {
+      checkShape(m);
+      for (size_t i = 0; i < nRows; i++)
+          tmatrix_detail::axpy(value_type(-1), tmatrix_detail::rowPointer(m, i), row(i).data(), nCols);
+      return *this;
+  }
+  TMatrixBlockView& operator*=(const value_type& val)
+  {
+      for (size_t i = 0; i < nRows; i++)
+          row(i) *= val;
+      return *this;
+  }
+
+private:
+  // блоки-источник и приёмник не должны перекрываться
+  template<typename M>
+  TMatrixBlockView& assign(const M& m)
+  {
+      checkShape(m);
+      for (size_t i = 0; i < nRows; i++)
+      {
+          const value_type* src = tmatrix_detail::rowPointer(m, i);
+          std::copy(src, src + nCols, row(i).data());
+      }
+      return *this;
+  }
+};
+
+// арифметика представлений векторов: результат - новый вектор
+template<typename A, typename B>
+typename std::enable_if<tmatrix_detail::TVectorViewOperands<A, B>::value, TDynamicVector<typename A::value_type>>::type
+operator+(const A& a, const B& b)
+{
+  return tmatrix_detail::combineElements(a, b, false);
+}
+
+template<typename A, typename B>
+typename std::enable_if<tmatrix_detail::TVectorViewOperands<A, B>::value, TDynamicVector<typename A::value_type>>::type
+operator-(const A& a, const B& b)
+{
+  return tmatrix_detail::combineElements(a, b, true);
+}
+
+// скалярное произведение
+template<typename A, typename B>
+typename std::enable_if<tmatrix_detail::TVectorViewOperands<A, B>::value, typename A::value_type>::type
+operator*(const A& a, const B& b)
+{
+  if (a.size() != b.size())
+      throw length_error("length error");
+  typename A::value_type sum = typename A::value_type();
+  for (size_t i = 0; i < a.size(); i++)
+      sum += a[i] * b[i];
+  return sum;
+}
+
+template<typename V>
+typename std::enable_if<tmatrix_detail::TIsVectorView<V>::value, TDynamicVector<typename V::value_type>>::type
+operator*(const V& v, const typename V::value_type& val)
+{
+  TDynamicVector<typename V::value_type> res = v.toVector();
+  for (size_t i = 0; i < res.size(); i++)
+      res[i] *= val;
+  return res;
+}
+
+template<typename V>
+typename std::enable_if<tmatrix_detail::TIsVectorView<V>::value, TDynamicVector<typename V::value_type>>::type
+operator+(const V& v, const typename V::value_type& val)
+{
+  TDynamicVector<typename V::value_type> res = v.toVector();
+  for (size_t i = 0; i < res.size(); i++)
+      res[i] += val;
+  return res;
+}
+
+template<typename V>
+typename std::enable_if<tmatrix_detail::TIsVectorView<V>::value, TDynamicVector<typename V::value_type>>::type
+operator-(const V& v, const typename V::value_type& val)
+{
+  TDynamicVector<typename V::value_type> res = v.toVector();
+  for (size_t i = 0; i < res.size(); i++)
+      res[i] -= val;
+  return res;
+}
+
+template<typename A, typename B>
+typename std::enable_if<tmatrix_detail::TVectorViewOperands<A, B>::value, bool>::type
+operator==(const A& a, const B& b)
+{
+  if (a.size() != b.size())
+      return false;
+  for (size_t i = 0; i < a.size(); i++)
+      if (a[i] != b[i])
+          return false;
+  return true;
+}
+
+template<typename A, typename B>
+typename std::enable_if<tmatrix_detail::TVectorViewOperands<A, B>::value, bool>::type
+operator!=(const A& a, const B& b)
+{
+  return !(a == b);
+}
+
+// арифметика блоков: результат - новая матрица
+template<typename A, typename B>
+typename std::enable_if<tmatrix_detail::TMatrixViewOperands<A, B>::value, TDynamicMatrix<typename A::value_type>>::type
+operator+(const A& a, const B& b)
+{
+  if (a.rows() != b.rows() || a.cols() != b.cols())
+      throw length_error("length error");
+  TDynamicMatrix<typename A::value_type> res(a.rows(), a.cols());
+  res.block(0, 0, a.rows(), a.cols()) = a;
+  res.block(0, 0, a.rows(), a.cols()) += b;
+  return res;
+}
+
+template<typename A, typename B>
+typename std::enable_if<tmatrix_detail::TMatrixViewOperands<A, B>::value, TDynamicMatrix<typename A::value_type>>::type
+operator-(const A& a, const B& b)
+{
+  if (a.rows() != b.rows() || a.cols() != b.cols())
+      throw length_error("length error");
+  TDynamicMatrix<typename A::value_type> res(a.rows(), a.cols());
+  res.block(0, 0, a.rows(), a.cols()) = a;
+  res.block(0, 0, a.rows(), a.cols()) -= b;
+  return res;
+}
+
+template<typename A, typename B>
+typename std::enable_if<tmatrix_detail::TMatrixViewOperands<A, B>::value, TDynamicMatrix<typename A::value_type>>::type
+operator*(const A& a, const B& b)
+{
+  typedef typename A::value_type T;
+  if (a.cols() != b.rows())
+      throw length_error("length error");
+  TDynamicMatrix<T> res(a.rows(), b.cols());
+  tmatrix_detail::gemmRows<T>(a.rows(), b.cols(), a.cols(),
+      [&](size_t i) { return tmatrix_detail::rowPointer(a, i); },
+      [&](size_t k) { return tmatrix_detail::rowPointer(b, k); },
+      [&](size_t i) { return res[i].data(); });
+  return res;
+}
+
+template<typename T, typename V>
+typename std::enable_if<tmatrix_detail::TIsVectorLike<V>::value, TDynamicVector<typename std::remove_const<T>::type>>::type
+operator*(const TMatrixBlockView<T>& a, const V& v)
+{
+  if (a.cols() != v.size())
+      throw length_error("length error");
+  TDynamicVector<typename std::remove_const<T>::type> res(a.rows());
+  for (size_t i = 0; i < a.rows(); i++)
+      res[i] = a.row(i) * v;
+  return res;
+}
+
+template<typename T>
+TDynamicMatrix<typename std::remove_const<T>::type> operator*(const TMatrixBlockView<T>& a, const typename std::remove_const<T>::type& val)
+{
+  TDynamicMatrix<typename std::remove_const<T>::type> res = a.toMatrix();
+  res.block(0, 0, a.rows(), a.cols()) *= val;
+  return res;
+}
+
+template<typename A, typename B>
+typename std::enable_if<tmatrix_detail::TMatrixViewOperands<A, B>::value, bool>::type
+operator==(const A& a, const B& b)
+{
+  if (a.rows() != b.rows() || a.cols() != b.cols())
+      return false;
+  for (size_t i = 0; i < a.rows(); i++)
+  {
+      const typename A::value_type* pa = tmatrix_detail::rowPointer(a, i);
+      const typename A::value_type* pb = tmatrix_detail::rowPointer(b, i);
+      for (size_t j = 0; j < a.cols(); j++)
+          if (pa[j] != pb[j])
+              return false;
+  }
+  return true;
+}
+
+template<typename A, typename B>
+typename std::enable_if<tmatrix_detail::TMatrixViewOperands<A, B>::value, bool>::type
+operator!=(const A& a, const B& b)
+{
+  return !(a == b);
+}
+
+namespace tmatrix_detail
+{
+  // Разделяемое хранилище с атомарным счётчиком ссылок: копирование
+  // за O(1), отделение собственной копии при первом изменяющем доступе.
+  // После выдачи изменяемого доступа блок помечается неразделяемым:
+  // выданные ссылки остаются привязаны к нему, поэтому следующее
+  // копирование создаёт собственную копию данных. Перемещение выполняется
+  // как копирование, поэтому исходный объект после него остаётся рабочим
+  template<typename C>
+  class TSharedStorage
+  {
+    struct TBlock
+    {
+      std::atomic<size_t> refs;
+      bool unshareable; // изменяется только владельцем единственной ссылки
+      C value;
+
+      explicit TBlock(const C& v) : refs(1), unshareable(false), value(v) {}
+      explicit TBlock(C&& v) : refs(1), unshareable(false), value(std::move(v)) {}
+    };
+
+    TBlock* block;
+
+    void release() noexcept
+    {
+        if (block != nullptr && block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete block;
+        block = nullptr;
+    }
+  public:
+    explicit TSharedStorage(const C& v) : block(new TBlock(v)) {}
+    explicit TSharedStorage(C&& v) : block(new TBlock(std::move(v))) {}
+
+    TSharedStorage(const TSharedStorage& s) : block(s.block)
+    {
+        if (block == nullptr)
+            return;
+        if (block->unshareable)
+            block = new TBlock(static_cast<const C&>(s.block->value));
+        else
+            block->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ~TSharedStorage()
+    {
+        release();
+    }
+
+    TSharedStorage& operator=(TSharedStorage s) noexcept
+    {
+        std::swap(block, s.block);
+        return *this;
+    }
+
+    const C& get() const noexcept { return block->value; }
+
+    // доступ на изменение: если данные разделены, создаётся своя копия;
+    // после этого блок больше не разделяется
+    C& mutate()
+    {
+        if (block->refs.load(std::memory_order_acquire) != 1)
+        {
+            TBlock* p = new TBlock(static_cast<const C&>(block->value));
+            release();
+            block = p;
+        }
+        block->unshareable = true;
+        return block->value;
+    }
+
+    size_t useCount() const noexcept { return block == nullptr ? 0 : block->refs.load(std::memory_order_acquire); }
+
+    void swap(TSharedStorage& s) noexcept { std::swap(block, s.block); }
+  };
+}
+
+// Вектор с копированием при записи: копии разделяют одну память,
+// первая запись через неконстантные operator[], at() или data()
+// отделяет собственную копию. После неконстантного доступа объект
+// больше не разделяет память, и его копии получают собственные данные,
+// поэтому запись по ранее полученной ссылке не видна в копиях. Чтобы
+// копии разделяли память, заполненный вектор передаётся в конструктор.
+template<typename T>
+class TCowVector
+{
+  tmatrix_detail::TSharedStorage<TDynamicVector<T>> storage;
+public:
+  typedef T value_type;
+
+  TCowVector(size_t size = 1) : storage(TDynamicVector<T>(size)) {}
+  TCowVector(const TDynamicVector<T>& v) : storage(v) {}
+  TCowVector(TDynamicVector<T>&& v) : storage(std::move(v)) {}
+
+  size_t size() const noexcept { return storage.get().size(); }
+
+  const TDynamicVector<T>& vector() const noexcept { return storage.get(); }
+  TDynamicVector<T>& mutableVector() { return storage.mutate(); }
+
+  const T* data() const noexcept { return storage.get().data(); }
+  T* data() { return storage.mutate().data(); }
+
+  const T& operator[](size_t ind) const { return storage.get()[ind]; }
+  T& operator[](size_t ind) { return storage.mutate()[ind]; }
+
+  const T& at(size_t ind) const { return storage.get().at(ind); }
+  T& at(size_t ind)
+  {
+      if (ind >= size())
+          throw range_error("range error");
+      return storage.mutate()[ind];
+  }
+
+  // число объектов, разделяющих память
+  size_t useCount() const noexcept { return storage.useCount(); }
+  bool isShared() const noexcept { return storage.useCount() > 1; }
+
+  bool operator==(const TCowVector& v) const noexcept
+  {
+      return &vector() == &v.vector() || vector() == v.vector();
+  }
+
+  bool operator!=(const TCowVector& v) const noexcept
+  {
+      return !(*this == v);
+  }
+
+  friend void swap(TCowVector& lhs, TCowVector& rhs) noexcept
+  {
+      lhs.storage.swap(rhs.storage);
+  }
+
+  friend ostream& operator<<(ostream& ostr, const TCowVector& v)
+  {
+      return ostr << v.vector();
+  }
+};
+
+// Матрица с копированием при записи; неконстантный operator[] и at()
+// отделяют копию всей матрицы и возвращают представление строки, через
+// которое нельзя изменить её длину. Как и у TCowVector, после
+// неконстантного доступа копии матрицы получают собственные данные
+template<typename T>
+class TCowMatrix
+{
+  tmatrix_detail::TSharedStorage<TDynamicMatrix<T>> storage;
+public:
+  typedef T value_type;
+
+  TCowMatrix(size_t s = 1) : storage(TDynamicMatrix<T>(s)) {}
+  TCowMatrix(size_t rows, size_t cols) : storage(TDynamicMatrix<T>(rows, cols)) {}
+  TCowMatrix(const TDynamicMatrix<T>& m) : storage(m) {}
+  TCowMatrix(TDynamicMatrix<T>&& m) : storage(std::move(m)) {}
+
+  size_t size() const noexcept { return storage.get().size(); }
+  size_t rows() const noexcept { return storage.get().rows(); }
+  size_t cols() const noexcept { return storage.get().cols(); }
+
+  const TDynamicMatrix<T>& matrix() const noexcept { return storage.get(); }
+  TDynamicMatrix<T>& mutableMatrix() { return storage.mutate(); }
+
+  const TDynamicVector<T>& operator[](size_t ind) const { return storage.get()[ind]; }
+  TMatrixRowView<T> operator[](size_t ind)
+  {
+      TDynamicMatrix<T>& m = storage.mutate();
+      return TMatrixRowView<T>(m[ind].data(), m.cols());
+  }
+
+  const TDynamicVector<T>& at(size_t ind) const { return storage.get().at(ind); }
+  TMatrixRowView<T> at(size_t ind)
+  {
+      if (ind >= size())
+          throw range_error("range error");
+      return (*this)[ind];
+  }
+
+  size_t useCount() const noexcept { return storage.useCount(); }
+  bool isShared() const noexcept { return storage.useCount() > 1; }
+
+  bool operator==(const TCowMatrix& m) const noexcept
+  {
+      return &matrix() == &m.matrix() || matrix() == m.matrix();
+  }
+
+  bool operator!=(const TCowMatrix& m) const noexcept
+  {
+      return !(*this == m);
+  }
+
+  friend void swap(TCowMatrix& lhs, TCowMatrix& rhs) noexcept
+  {
+      lhs.storage.swap(rhs.storage);
+  }
+
+  friend ostream& operator<<(ostream& ostr, const TCowMatrix& m)
+  {
+      return ostr << m.matrix();
+  }
+};
+
+
+// Разложение Холецкого A = L * L^T для симметричной положительно
+// определённой матрицы. Используется только нижний треугольник A,
+// на его место записывается L; верхний треугольник не изменяется.
+template<typename T>
+void cholesky(TDynamicMatrix<T>& a)
+{
+  static_assert(std::is_floating_point<T>::value, "cholesky requires floating point type");
+  const size_t n = a.size();
+  if (a.cols() != n)
+      throw length_error("matrix must be square");
+  const size_t rowGrain = 8;
+
+  for (size_t k = 0; k < n; k += MATRIX_BLOCK_SIZE)
+  {
+      const size_t kend = std::min(k + MATRIX_BLOCK_SIZE, n);
+
+      // диагональный блок
+      for (size_t j = k; j < kend; j++)
+      {
+          T* aj = a[j].data();
+          T d = aj[j] - tmatrix_detail::dot(aj + k, aj + k, j - k);
+          if (!(d > T(0)))
+              throw domain_error("matrix is not positive definite");
+          d = std::sqrt(d);
+          aj[j] = d;
+          for (size_t i = j + 1; i < kend; i++)
+          {
+              T* ai = a[i].data();
+              ai[j] = (ai[j] - tmatrix_detail::dot(ai + k, aj + k, j - k)) / d;
+          }
+      }
+
+      // панель под диагональным блоком: L21 = A21 * L11^-T
+      tmatrix_detail::parallelFor(kend, n, rowGrain, [&](size_t first, size_t last)
+      {
+          for (size_t i = first; i < last; i++)
+          {
+              T* ai = a[i].data();
+              for (size_t j = k; j < kend; j++)
+              {
+                  const T* aj = a[j].data();
+                  ai[j] = (ai[j] - tmatrix_detail::dot(ai + k, aj + k, j - k)) / aj[j];
+              }
+          }
+      });
+
+      // обновление оставшегося нижнего треугольника: A22 -= L21 * L21^T
+      tmatrix_detail::parallelFor(kend, n, rowGrain, [&](size_t first, size_t last)
+      {
+          for (size_t i = first; i < last; i++)
+          {
+              T* ai = a[i].data();
+              for (size_t j = kend; j <= i; j++)
+                  ai[j] -= tmatrix_detail::dot(ai + k, a[j].data() + k, kend - k);
+          }
+      });
+  }
+}
+
+// Решение L * X = B (L - нижнетреугольная) для всех столбцов B на месте
+template<typename T>
+void solveLowerInPlace(const TDynamicMatrix<T>& l, TDynamicMatrix<T>& b, bool unitDiagonal = false)
+{
+  const size_t n = l.size();
+  if (l.cols() != n)
+      throw length_error("matrix must be square");
+  if (b.size() != n)
+      throw length_error("length error");
+  const size_t m = b.cols();
+
+  tmatrix_detail::parallelFor(0, m, MATRIX_BLOCK_SIZE, [&](size_t c0, size_t c1)
+  {
+      for (size_t i = 0; i < n; i++)
+      {
+          const T* li = l[i].data();
+          T* bi = b[i].data() + c0;
+          for (size_t k = 0; k < i; k++)
+              tmatrix_detail::axpy(-li[k], b[k].data() + c0, bi, c1 - c0);
+          if (!unitDiagonal)
+          {
+              if (li[i] == T(0))
+                  throw domain_error("matrix is singular");
+              for (size_t c = 0; c < c1 - c0; c++)
+                  bi[c] /= li[i];
+          }
+      }
+  });
+}
+
+// Решение U * X = B (U - верхнетреугольная) для всех столбцов B на месте
+template<typename T>
+void solveUpperInPlace(const TDynamicMatrix<T>& u, TDynamicMatrix<T>& b, bool unitDiagonal = false)
+{
+  const size_t n = u.size();
+  if (u.cols() != n)
+      throw length_error("matrix must be square");
+  if (b.size() != n)
+      throw length_error("length error");
+  const size_t m = b.cols();
+
+  tmatrix_detail::parallelFor(0, m, MATRIX_BLOCK_SIZE, [&](size_t c0, size_t c1)
+  {
+      for (size_t i = n; i-- > 0;)
+      {
+          const T* ui = u[i].data();
+          T* bi = b[i].data() + c0;
+          for (size_t k = i + 1; k < n; k++)
+              tmatrix_detail::axpy(-ui[k], b[k].data() + c0, bi, c1 - c0);
+          if (!unitDiagonal)
+          {
+              if (ui[i] == T(0))
+                  throw domain_error("matrix is singular");
+              for (size_t c = 0; c < c1 - c0; c++)
+                  bi[c] /= ui[i];
+          }
+      }
+  });
+}
+
+// Решение L^T * X = B по нижнему треугольнику L для всех столбцов B на месте
+template<typename T>
+void solveLowerTransposedInPlace(const TDynamicMatrix<T>& l, TDynamicMatrix<T>& b, bool unitDiagonal = false)
+{
+  const size_t n = l.size();
+  if (l.cols() != n)
+      throw length_error("matrix must be square");
+  if (b.size() != n)
+      throw length_error("length error");
+  const size_t m = b.cols();
+
+  tmatrix_detail::parallelFor(0, m, MATRIX_BLOCK_SIZE, [&](size_t c0, size_t c1)
+  {
+      for (size_t i = n; i-- > 0;)
+      {
+          const T* li = l[i].data();
+          T* bi = b[i].data() + c0;
+          if (!unitDiagonal)
+          {
+              if (li[i] == T(0))
+                  throw domain_error("matrix is singular");
+              for (size_t c = 0; c < c1 - c0; c++)
+                  bi[c] /= li[i];
+          }
+          for (size_t k = 0; k < i; k++)
+              tmatrix_detail::axpy(-li[k], bi, b[k].data() + c0, c1 - c0);
+      }
+  });
+}
+
+// Решение A * X = B по разложению Холецкого A = L * L^T
+template<typename T>
+void choleskySolveInPlace(const TDynamicMatrix<T>& l, TDynamicMatrix<T>& b)
+{
+  solveLowerInPlace(l, b);
+  solveLowerTransposedInPlace(l, b);
+}
+
+template<typename T>
+void choleskySolveInPlace(const TDynamicMatrix<T>& l, TDynamicVector<T>& b)
+{
+  const size_t n = l.size();
+  if (b.size() != n)
+      throw length_error("length error");
+  T* x = b.data();
+  for (size_t i = 0; i < n; i++)
+  {
+      const T* li = l[i].data();
+      x[i] = (x[i] - tmatrix_detail::dot(li, x, i)) / li[i];
+  }
+  for (size_t i = n; i-- > 0;)
+  {
+      const T* li = l[i].data();
+      x[i] /= li[i];
+      tmatrix_detail::axpy(-x[i], li, x, i);
+  }
+}
+
+namespace tmatrix_detail
+{
+  // элемент i вектора отражения p панели, начинающейся со столбца k
+  // (единица на диагонали подразумевается, выше диагонали - нули)
+  template<typename T>
+  T reflectorElement(const TDynamicMatrix<T>& qr, size_t k, size_t p, size_t i) noexcept
+  {
+      if (i < k + p)
+          return T(0);
+      if (i == k + p)
+          return T(1);
+      return qr[i][k + p];
+  }
+
+  // Неблочное QR-разложение столбцов [k, kend) с обновлением только этих столбцов
+  template<typename T>
+  void householderPanel(TDynamicMatrix<T>& a, TDynamicVector<T>& tau, size_t k, size_t kend)
+  {
+      const size_t m = a.size();
+      std::vector<T> w(kend - k);
+      for (size_t j = k; j < kend; j++)
+      {
+          T alpha = a[j][j];
+          T sigma = T(0);
+          for (size_t i = j + 1; i < m; i++)
+              sigma += a[i][j] * a[i][j];
+          if (sigma == T(0))
+          {
+              tau[j] = T(0);
+              continue;
+          }
+          T beta = std::sqrt(alpha * alpha + sigma);
+          if (alpha > T(0))
+              beta = -beta;
+          tau[j] = (beta - alpha) / beta;
+          const T scale = T(1) / (alpha - beta);
+          for (size_t i = j + 1; i < m; i++)
+              a[i][j] *= scale;
+          a[j][j] = beta;
+
+          // применение H_j к оставшимся столбцам панели
+          const size_t cnt = kend - j - 1;
+          if (cnt == 0)
+              continue;
+          std::copy(a[j].data() + j + 1, a[j].data() + kend, w.begin());
+          for (size_t i = j + 1; i < m; i++)
+              axpy(a[i][j], a[i].data() + j + 1, w.data(), cnt);
+          for (size_t c = 0; c < cnt; c++)
+              w[c] *= tau[j];
+          axpy(T(-1), w.data(), a[j].data() + j + 1, cnt);
+          for (size_t i = j + 1; i < m; i++)
+              axpy(-a[i][j], w.data(), a[i].data() + j + 1, cnt);
+      }
+  }
+
+  // Треугольный множитель компактного WY-представления H_k ... H_{kend-1} = I - V * T * V^T
+  template<typename T>
+  void buildWYFactor(const TDynamicMatrix<T>& qr, const TDynamicVector<T>& tau, size_t k, size_t kend, std::vector<T>& t)
+  {
+      const size_t m = qr.size();
+      const size_t kb = kend - k;
+      t.assign(kb * kb, T(0));
+      std::vector<T> z(kb);
+      for (size_t j = 0; j < kb; j++)
+      {
+          t[j * kb + j] = tau[k + j];
+          if (j == 0)
+              continue;
+          for (size_t p = 0; p < j; p++)
+          {
+              T s = qr[k + j][k + p];
+              for (size_t i = k + j + 1; i < m; i++)
+                  s += qr[i][k + p] * qr[i][k + j];
+              z[p] = s;
+          }
+          for (size_t p = 0; p < j; p++)
+          {
+              T s = T(0);
+              for (size_t q = p; q < j; q++)
+                  s += t[p * kb + q] * z[q];
+              t[p * kb + j] = -tau[k + j] * s;
+          }
+      }
+  }
+
+  // B[k:m, c0:c1] = (I - V * op(T) * V^T) * B[k:m, c0:c1], op(T) = T или T^T
+  template<typename T>
+  void applyBlockReflector(const TDynamicMatrix<T>& qr, size_t k, size_t kend, const std::vector<T>& t,
+      TDynamicMatrix<T>& b, size_t c0, size_t c1, bool transposed)
+  {
+      const size_t m = qr.size();
+      const size_t kb = kend - k;
+      const size_t cnt = c1 - c0;
+      std::vector<T> w(kb * cnt, T(0)), tw(kb * cnt, T(0));
+
+      // W = V^T * B
+      for (size_t i = k; i < m; i++)
+      {
+          const T* bi = b[i].data() + c0;
+          const size_t pend = std::min(kb, i - k + 1);
+          for (size_t p = 0; p < pend; p++)
+              axpy(reflectorElement(qr, k, p, i), bi, w.data() + p * cnt, cnt);
+      }
+      // W = op(T) * W
+      for (size_t p = 0; p < kb; p++)
+      {
+          T* twp = tw.data() + p * cnt;
+          if (transposed)
+              for (size_t q = 0; q <= p; q++)
+                  axpy(t[q * kb + p], w.data() + q * cnt, twp, cnt);
+          else
+              for (size_t q = p; q < kb; q++)
+                  axpy(t[p * kb + q], w.data() + q * cnt, twp, cnt);
+      }
+      // B -= V * W
+      for (size_t i = k; i < m; i++)
+      {
+          T* bi = b[i].data() + c0;
+          const size_t pend = std::min(kb, i - k + 1);
+          for (size_t p = 0; p < pend; p++)
+              axpy(-reflectorElement(qr, k, p, i), tw.data() + p * cnt, bi, cnt);
+      }
+  }
+
+  template<typename T>
+  void applyQImpl(const TDynamicMatrix<T>& qr, const TDynamicVector<T>& tau, TDynamicMatrix<T>& b, bool transposed)
+  {
+      const size_t m = qr.size();
+      const size_t kmax = tau.size();
+      if (b.size() != m)
+          throw length_error("length error");
+      const size_t ncols = b.cols();
+
+      std::vector<size_t> panels;
+      for (size_t k = 0; k < kmax; k += MATRIX_BLOCK_SIZE)
+          panels.push_back(k);
+      if (!transposed)
+          std::reverse(panels.begin(), panels.end());
+
+      std::vector<T> t;
+      for (size_t k : panels)
+      {
+          const size_t kend = std::min(k + MATRIX_BLOCK_SIZE, kmax);
+          buildWYFactor(qr, tau, k, kend, t);
+          parallelFor(0, ncols, MATRIX_BLOCK_SIZE, [&](size_t c0, size_t c1)
+          {
+              applyBlockReflector(qr, k, kend, t, b, c0, c1, transposed);
+          });
+      }
+  }
+
+  template<typename T>
+  void applyQImpl(const TDynamicMatrix<T>& qr, const TDynamicVector<T>& tau, TDynamicVector<T>& b, bool transposed)
+  {
+      const size_t m = qr.size();
+      const size_t kmax = tau.size();
+      if (b.size() != m)
+          throw length_error("length error");
+
+      for (size_t s = 0; s < kmax; s++)
+      {
+          const size_t j = transposed ? s : kmax - 1 - s;
+          T w = b[j];
+          for (size_t i = j + 1; i < m; i++)
+              w += qr[i][j] * b[i];
+          w *= tau[j];
+          b[j] -= w;
+          for (size_t i = j + 1; i < m; i++)
+              b[i] -= qr[i][j] * w;
+      }
+  }
+}
+
+// QR-разложение Хаусхолдера A = Q * R на месте. R записывается в верхний
+// треугольник, векторы отражений - под диагональ, их коэффициенты - в tau.
+// Отражения каждой панели объединяются в компактное WY-представление,
+// так что обновление оставшейся части - матрично-матричное.
+template<typename T>
+void householderQR(TDynamicMatrix<T>& a, TDynamicVector<T>& tau)
+{
+  static_assert(std::is_floating_point<T>::value, "householderQR requires floating point type");
+  const size_t m = a.size();
+  const size_t n = a.cols();
+  const size_t kmax = std::min(m, n);
+  tau = TDynamicVector<T>(kmax);
+
+  std::vector<T> t;
+  for (size_t k = 0; k < kmax; k += MATRIX_BLOCK_SIZE)
+  {
+      const size_t kend = std::min(k + MATRIX_BLOCK_SIZE, kmax);
+      tmatrix_detail::householderPanel(a, tau, k, kend);
+      if (kend >= n)
+          continue;
+      tmatrix_detail::buildWYFactor(a, tau, k, kend, t);
+      tmatrix_detail::parallelFor(kend, n, MATRIX_BLOCK_SIZE, [&](size_t c0, size_t c1)
+      {
+          tmatrix_detail::applyBlockReflector(a, k, kend, t, a, c0, c1, true);
+      });
+  }
+}
+
+// B = Q * B без явного построения Q
+template<typename T>
+void applyQ(const TDynamicMatrix<T>& qr, const TDynamicVector<T>& tau, TDynamicMatrix<T>& b)
+{
+  tmatrix_detail::applyQImpl(qr, tau, b, false);
+}
+
+template<typename T>
+void applyQ(const TDynamicMatrix<T>& qr, const TDynamicVector<T>& tau, TDynamicVector<T>& b)
+{
+  tmatrix_detail::applyQImpl(qr, tau, b, false);
+}
+
+// B = Q^T * B без явного построения Q
+template<typename T>
+void applyQTransposed(const TDynamicMatrix<T>& qr, const TDynamicVector<T>& tau, TDynamicMatrix<T>& b)
+{
+  tmatrix_detail::applyQImpl(qr, tau, b, true);
+}
+
+template<typename T>
+void applyQTransposed(const TDynamicMatrix<T>& qr, const TDynamicVector<T>& tau, TDynamicVector<T>& b)
+{
+  tmatrix_detail::applyQImpl(qr, tau, b, true);
+}
+
+// Решение задачи наименьших квадратов min ||A * x - b|| по QR-разложению A
+template<typename T>
+TDynamicVector<T> qrSolve(const TDynamicMatrix<T>& qr, const TDynamicVector<T>& tau, const TDynamicVector<T>& b)
+{
+  const size_t n = qr.cols();
+  if (qr.size() < n)
+      throw length_error("least squares requires rows >= cols");
+  TDynamicVector<T> y(b);
+  applyQTransposed(qr, tau, y);
+
+  TDynamicVector<T> x(n);
+  for (size_t i = n; i-- > 0;)
+  {
+      const T* ri = qr[i].data();
+      if (ri[i] == T(0))
+          throw domain_error("matrix is rank deficient");
+      x[i] = (y[i] - tmatrix_detail::dot(ri + i + 1, x.data() + i + 1, n - i - 1)) / ri[i];
+  }
+  return x;
+}
+
+namespace tmatrix_detail
+{
+  // треугольная подстановка для одной правой части
+  template<typename T>
+  void solveTriangularVector(const TDynamicMatrix<T>& t, TDynamicVector<T>& b, bool lower)
+  {
+      const size_t n = t.size();
+      if (t.cols() != n)
+          throw length_error("matrix must be square");
+      if (b.size() != n)
+          throw length_error("length error");
+      T* x = b.data();
+      for (size_t s = 0; s < n; s++)
+      {
+          const size_t i = lower ? s : n - 1 - s;
+          const T* ti = t[i].data();
+          if (ti[i] == T(0))
+              throw domain_error("matrix is singular");
+          T r = lower ? dot(ti, x, i) : dot(ti + i + 1, x + i + 1, n - i - 1);
+          x[i] = (x[i] - r) / ti[i];
+      }
+  }
+}
+
+
+// LU-разложение с выбором ведущего элемента по столбцу P * A = L * U на месте.
+// L (с единичной диагональю) записывается под диагональ, U - в верхний
+// треугольник; pivots[j] - строка, переставленная со строкой j на шаге j.
+// Возвращает знак перестановки (+1 или -1) или 0, если матрица вырождена.
+template<typename T>
+int lu(TDynamicMatrix<T>& a, TDynamicVector<size_t>& pivots)
+{
+  static_assert(std::is_floating_point<T>::value, "lu requires floating point type");
+  const size_t n = a.size();
+  if (a.cols() != n)
+      throw length_error("matrix must be square");
+  const size_t rowGrain = 8;
+  pivots = TDynamicVector<size_t>(n);
+  int sign = 1;
+  bool singular = false;
+
+  for (size_t k = 0; k < n; k += MATRIX_BLOCK_SIZE)
+  {
+      const size_t kend = std::min(k + MATRIX_BLOCK_SIZE, n);
+
+      // панель [k, n) x [k, kend): перестановки строк применяются к строкам целиком
+      for (size_t j = k; j < kend; j++)
+      {
+          size_t p = j;
+          for (size_t i = j + 1; i < n; i++)
+              if (std::abs(a[i][j]) > std::abs(a[p][j]))
+                  p = i;
+          pivots[j] = p;
+          if (p != j)
+          {
+              swap(a[p], a[j]);
+              sign = -sign;
+          }
+          const T* aj = a[j].data();
+          if (aj[j] == T(0))
+          {
+              singular = true;
+              continue;
+          }
+          for (size_t i = j + 1; i < n; i++)
+          {
+              T* ai = a[i].data();
+              ai[j] /= aj[j];
+              tmatrix_detail::axpy(-ai[j], aj + j + 1, ai + j + 1, kend - j - 1);
+          }
+      }
+      if (kend == n)
+          break;
+
+      // U12 = L11^-1 * A12
+      tmatrix_detail::parallelFor(kend, n, MATRIX_BLOCK_SIZE, [&](size_t c0, size_t c1)
+      {
+          for (size_t i = k + 1; i < kend; i++)
+          {
+              T* ai = a[i].data();
+              for (size_t p = k; p < i; p++)
+                  tmatrix_detail::axpy(-ai[p], a[p].data() + c0, ai + c0, c1 - c0);
+          }
+      });
+
+      // A22 -= L21 * U12
+      tmatrix_detail::parallelFor(kend, n, rowGrain, [&](size_t first, size_t last)
+      {
+          for (size_t i = first; i < last; i++)
+          {
+              T* ai = a[i].data();
+              for (size_t p = k; p < kend; p++)
+                  tmatrix_detail::axpy(-ai[p], a[p].data() + kend, ai + kend, n - kend);
+          }
+      });
+  }
+  return singular ? 0 : sign;
+}
+
+// Решение A * X = B по LU-разложению для всех столбцов B на месте
+template<typename T>
+void luSolveInPlace(const TDynamicMatrix<T>& lu, const TDynamicVector<size_t>& pivots, TDynamicMatrix<T>& b)
+{
+  const size_t n = lu.size();
+  if (b.size() != n || pivots.size() != n)
+      throw length_error("length error");
+  for (size_t j = 0; j < n; j++)
+      if (pivots[j] != j)
+          swap(b[j], b[pivots[j]]);
+  solveLowerInPlace(lu, b, true);
+  solveUpperInPlace(lu, b);
+}
+
+template<typename T>
+void luSolveInPlace(const TDynamicMatrix<T>& lu, const TDynamicVector<size_t>& pivots, TDynamicVector<T>& b)
+{
+  const size_t n = lu.size();
+  if (b.size() != n || pivots.size() != n)
+      throw length_error("length error");
+  T* x = b.data();
+  for (size_t j = 0; j < n; j++)
+      std::swap(x[j], x[pivots[j]]);
+  for (size_t i = 0; i < n; i++)
+      x[i] -= tmatrix_detail::dot(lu[i].data(), x, i);
+  for (size_t i = n; i-- > 0;)
+  {
+      const T* ui = lu[i].data();
+      if (ui[i] == T(0))
+          throw domain_error("matrix is singular");
+      x[i] = (x[i] - tmatrix_detail::dot(ui + i + 1, x + i + 1, n - i - 1)) / ui[i];
+  }
+}
+
+// Объявленная структура матрицы системы
+enum class TMatrixStructure
+{
+  General,                   // LU-разложение
+  SymmetricPositiveDefinite, // разложение Холецкого (нижний треугольник)
+  LowerTriangular,           // прямая подстановка
+  UpperTriangular            // обратная подстановка
+};
+
+// Решатель СЛАУ: матрица раскладывается один раз при создании,
+// разложение переиспользуется для любого числа правых частей
+template<typename T>
+class TLinearSolver
+{
+  TDynamicMatrix<T> factor;
+  TDynamicVector<size_t> pivots;
+  TMatrixStructure structure;
+public:
+  TLinearSolver(const TDynamicMatrix<T>& a, TMatrixStructure s = TMatrixStructure::General)
+      : factor(a), pivots(a.size()), structure(s)
+  {
+      if (structure == TMatrixStructure::General)
+      {
+          if (lu(factor, pivots) == 0)
+              throw domain_error("matrix is singular");
+      }
+      else if (structure == TMatrixStructure::SymmetricPositiveDefinite)
+          cholesky(factor);
+  }
+
+  size_t size() const noexcept { return factor.size(); }
+  TMatrixStructure getStructure() const noexcept { return structure; }
+
+  // решение на месте: столбцы B - правые части
+  void solveInPlace(TDynamicMatrix<T>& b) const
+  {
+      switch (structure)
+      {
+      case TMatrixStructure::General:
+          luSolveInPlace(factor, pivots, b);
+          break;
+      case TMatrixStructure::SymmetricPositiveDefinite:
+          choleskySolveInPlace(factor, b);
+          break;
+      case TMatrixStructure::LowerTriangular:
+          solveLowerInPlace(factor, b);
+          break;
+      case TMatrixStructure::UpperTriangular:
+          solveUpperInPlace(factor, b);
+          break;
+      }
+  }
+
+  void solveInPlace(TDynamicVector<T>& b) const
+  {
+      switch (structure)
+      {
+      case TMatrixStructure::General:
+          luSolveInPlace(factor, pivots, b);
+          break;
+      case TMatrixStructure::SymmetricPositiveDefinite:
+          choleskySolveInPlace(factor, b);
+          break;
+      case TMatrixStructure::LowerTriangular:
+      case TMatrixStructure::UpperTriangular:
+          tmatrix_detail::solveTriangularVector(factor, b, structure == TMatrixStructure::LowerTriangular);
+          break;
+      }
+  }
+
+  TDynamicVector<T> solve(const TDynamicVector<T>& b) const
+  {
+      TDynamicVector<T> x(b);
+      solveInPlace(x);
+      return x;
+  }
+
+  TDynamicMatrix<T> solve(const TDynamicMatrix<T>& b) const
+  {
+      TDynamicMatrix<T> x(b);
+      solveInPlace(x);
+      return x;
+  }
+};
+
+// Решение A * x = b
+template<typename T>
+TDynamicVector<T> solve(const TDynamicMatrix<T>& a, const TDynamicVector<T>& b,
+    TMatrixStructure s = TMatrixStructure::General)
+{
+  if (a.size() != b.size())
+      throw length_error("length error");
+  TDynamicVector<T> x(b);
+  if (s == TMatrixStructure::LowerTriangular || s == TMatrixStructure::UpperTriangular)
+      tmatrix_detail::solveTriangularVector(a, x, s == TMatrixStructure::LowerTriangular);
+  else
+      TLinearSolver<T>(a, s).solveInPlace(x);
+  return x;
+}
+
+// Решение A * X = B для всех столбцов B с однократным разложением A
+template<typename T>
+TDynamicMatrix<T> solve(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b,
+    TMatrixStructure s = TMatrixStructure::General)
+{
+  if (a.size() != b.size())
+      throw length_error("length error");
+  TDynamicMatrix<T> x(b);
+  if (s == TMatrixStructure::LowerTriangular)
+      solveLowerInPlace(a, x);
+  else if (s == TMatrixStructure::UpperTriangular)
+      solveUpperInPlace(a, x);
+  else
+      TLinearSolver<T>(a, s).solveInPlace(x);
+  return x;
+}
+
+namespace tmatrix_detail
+{
+  // y = A * x; тип элементов y может отличаться от типа хранения A и x
+  template<typename T, typename Y>
+  void gemv(const TDynamicMatrix<T>& a, const TDynamicVector<T>& x, TDynamicVector<Y>& y)
+  {
+      const size_t m = a.size();
+      const size_t n = x.size();
+      if (a.cols() != n || y.size() != m)
+          throw length_error("length error");
+      TMATRIX_OPERATION(TOperation::Gemv, m * n, 2 * m * n, (m * n + n) * sizeof(T) + m * sizeof(Y));
+      const size_t rowGrain = std::max<size_t>(1, 16384 / n);
+      parallelFor(0, m, rowGrain, [&](size_t first, size_t last)
+      {
+          for (size_t i = first; i < last; i++)
+              y[i] = Y(dot(a[i].data(), x.data(), n));
+      });
+  }
+
+  // C = A * B; тип элементов C может отличаться от типа хранения A и B
+  template<typename T, typename C>
+  void gemm(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b, TDynamicMatrix<C>& c)
+  {
+      const size_t m = a.size();
+      const size_t kn = b.size();
+      const size_t n = b.cols();
+      if (a.cols() != kn || c.size() != m || c.cols() != n)
+          throw length_error("length error");
+      if (static_cast<const void*>(&c) == &a || static_cast<const void*>(&c) == &b)
+          throw invalid_argument("output matrix must not alias an operand");
+      TMATRIX_OPERATION(TOperation::Gemm, m * n, 2 * m * n * kn, (m * kn + kn * n) * sizeof(T) + m * n * sizeof(C));
+
+      gemmRows<T>(m, n, kn,
+          [&](size_t i) { return a[i].data(); },
+          [&](size_t k) { return b[k].data(); },
+          [&](size_t i) { return c[i].data(); });
+  }
+}
+
+// y = A * x без выделения памяти
+template<typename T>
+void multiply(const TDynamicMatrix<T>& a, const TDynamicVector<T>& x, TDynamicVector<T>& y)
+{
+  tmatrix_detail::gemv(a, x, y);
+}
+
+// C = A * B без выделения памяти
+template<typename T>
+void multiply(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b, TDynamicMatrix<T>& c)
+{
+  tmatrix_detail::gemm(a, b, c);
+}
+
+// Смешанная точность: A, x и B хранятся в THalf или TBFloat16, произведение
+// накапливается и возвращается во float
+template<typename S>
+typename std::enable_if<tmatrix_detail::TIsReducedPrecision<S>::value>::type
+multiply(const TDynamicMatrix<S>& a, const TDynamicVector<S>& x, TDynamicVector<typename tmatrix_detail::TAccumulator<S>::type>& y)
+{
+  tmatrix_detail::gemv(a, x, y);
+}
+
+template<typename S>
+typename std::enable_if<tmatrix_detail::TIsReducedPrecision<S>::value>::type
+multiply(const TDynamicMatrix<S>& a, const TDynamicMatrix<S>& b, TDynamicMatrix<typename tmatrix_detail::TAccumulator<S>::type>& c)
+{
+  tmatrix_detail::gemm(a, b, c);
+}
+
+// Порядок суммирования в параллельных свёртках
+enum class TReductionMode
+{
+  Fast,         // куски по числу потоков; результат может зависеть от числа потоков
+  Deterministic // куски фиксированного размера и фиксированное дерево сложения
+};
+
+namespace tmatrix_detail
+{
+  template<typename A>
+  A absValue(A x)
+  {
+      return x < A() ? A(-x) : x;
+  }
+
+  template<typename A, typename T>
+  A sumBlock(const T* x, size_t n)
+  {
+      A s0 = A(), s1 = A(), s2 = A(), s3 = A();
+      size_t i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+          s0 += A(x[i]);
+          s1 += A(x[i + 1]);
+          s2 += A(x[i + 2]);
+          s3 += A(x[i + 3]);
+      }
+      for (; i < n; i++)
+          s0 += A(x[i]);
+      return (s0 + s1) + (s2 + s3);
+  }
+
+  template<typename A, typename T>
+  A absSumBlock(const T* x, size_t n)
+  {
+      A s0 = A(), s1 = A(), s2 = A(), s3 = A();
+      size_t i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+          s0 += absValue(A(x[i]));
+          s1 += absValue(A(x[i + 1]));
+          s2 += absValue(A(x[i + 2]));
+          s3 += absValue(A(x[i + 3]));
+      }
+      for (; i < n; i++)
+          s0 += absValue(A(x[i]));
+      return (s0 + s1) + (s2 + s3);
+  }
+
+  template<typename A, typename T>
+  A squareSumBlock(const T* x, size_t n)
+  {
+      A s0 = A(), s1 = A(), s2 = A(), s3 = A();
+      size_t i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+          s0 += A(x[i]) * A(x[i]);
+          s1 += A(x[i + 1]) * A(x[i + 1]);
+          s2 += A(x[i + 2]) * A(x[i + 2]);
+          s3 += A(x[i + 3]) * A(x[i + 3]);
+      }
+      for (; i < n; i++)
+          s0 += A(x[i]) * A(x[i]);
+      return (s0 + s1) + (s2 + s3);
+  }
+
+  template<typename A, typename T>
+  A maxAbsBlock(const T* x, size_t n)
+  {
+      A m0 = A(), m1 = A(), m2 = A(), m3 = A();
+      size_t i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+          m0 = std::max(m0, absValue(A(x[i])));
+          m1 = std::max(m1, absValue(A(x[i + 1])));
+          m2 = std::max(m2, absValue(A(x[i + 2])));
+          m3 = std::max(m3, absValue(A(x[i + 3])));
+      }
+      for (; i < n; i++)
+          m0 = std::max(m0, absValue(A(x[i])));
+      return std::max(std::max(m0, m1), std::max(m2, m3));
+  }
+
+  // индекс первого максимального (Less = std::less) или минимального
+  // (Less = std::greater) элемента; n > 0
+  template<typename T, typename Less>
+  size_t extremumBlock(const T* x, size_t n, Less less)
+  {
+      size_t best[4] = { 0, 0, 0, 0 };
+      size_t i = 0;
+      if (n >= 4)
+      {
+          for (size_t l = 0; l < 4; l++)
+              best[l] = l;
+          for (i = 4; i + 4 <= n; i += 4)
+              for (size_t l = 0; l < 4; l++)
+                  if (less(x[best[l]], x[i + l]))
+                      best[l] = i + l;
+      }
+      size_t res = best[0];
+      for (size_t l = 1; l < 4; l++)
+          if (less(x[res], x[best[l]]) || (!less(x[best[l]], x[res]) && best[l] < res))
+              res = best[l];
+      for (; i < n; i++)
+          if (less(x[res], x[i]))
+              res = i;
+      return res;
+  }
+
+  // Свёртка по [0, count): block(first, last) даёт частичный результат,
+  // combine объединяет два частичных. unit - размер куска в режиме
+  // Deterministic и минимальный размер куска в режиме Fast. Частичные
+  // результаты объединяются попарным деревом в порядке кусков.
+  template<typename R, typename Block, typename Combine>
+  R reduce(size_t count, size_t unit, TReductionMode mode, Block block, Combine combine)
+  {
+      size_t grain = unit;
+      if (mode == TReductionMode::Fast)
+      {
+          const size_t threads = threadCount().load();
+          grain = std::max(unit, (count + threads - 1) / threads);
+      }
+      const size_t parts = (count + grain - 1) / grain;
+      if (parts <= 1)
+          return block(0, count);
+
+      std::vector<R> partial(parts);
+      parallelFor(0, parts, 1, [&](size_t first, size_t last)
+      {
+          for (size_t p = first; p < last; p++)
+              partial[p] = block(p * grain, std::min(count, (p + 1) * grain));
+      });
+      for (size_t step = 1; step < parts; step *= 2)
+          for (size_t p = 0; p + step < parts; p += 2 * step)
+              partial[p] = combine(partial[p], partial[p + step]);
+      return partial[0];
+  }
+
+  // число элементов в куске параллельной свёртки
+  const size_t reductionBlock = 16384;
+
+  inline size_t reductionRows(size_t cols)
+  {
+      return std::max<size_t>(1, reductionBlock / cols);
+  }
+
+  template<typename A>
+  A addPartials(const A& x, const A& y)
+  {
+      return x + y;
+  }
+
+  template<typename A>
+  A maxPartials(const A& x, const A& y)
+  {
+      return std::max(x, y);
+  }
+}
+
+// Свёртки векторов. Суммы копятся в типе TAccumulator<T>::type
+// (float для THalf и TBFloat16)
+template<typename T>
+typename tmatrix_detail::TAccumulator<T>::type sum(const TDynamicVector<T>& v, TReductionMode mode = TReductionMode::Fast)
+{
+  typedef typename tmatrix_detail::TAccumulator<T>::type A;
+  return tmatrix_detail::reduce<A>(v.size(), tmatrix_detail::reductionBlock, mode,
+      [&](size_t first, size_t last) { return tmatrix_detail::sumBlock<A>(v.data() + first, last - first); },
+      tmatrix_detail::addPartials<A>);
+}
+
+template<typename T>
+typename tmatrix_detail::TAccumulator<T>::type norm1(const TDynamicVector<T>& v, TReductionMode mode = TReductionMode::Fast)
+{
+  typedef typename tmatrix_detail::TAccumulator<T>::type A;
+  return tmatrix_detail::reduce<A>(v.size(), tmatrix_detail::reductionBlock, mode,
+      [&](size_t first, size_t last) { return tmatrix_detail::absSumBlock<A>(v.data() + first, last - first); },
+      tmatrix_detail::addPartials<A>);
+}
+
+template<typename T>
+auto norm2(const TDynamicVector<T>& v, TReductionMode mode = TReductionMode::Fast)
+    -> decltype(std::sqrt(typename tmatrix_detail::TAccumulator<T>::type()))
+{
+  typedef typename tmatrix_detail::TAccumulator<T>::type A;
+  return std::sqrt(tmatrix_detail::reduce<A>(v.size(), tmatrix_detail::reductionBlock, mode,
+      [&](size_t first, size_t last) { return tmatrix_detail::squareSumBlock<A>(v.data() + first, last - first); },
+      tmatrix_detail::addPartials<A>));
+}
+
+template<typename T>
+typename tmatrix_detail::TAccumulator<T>::type normInf(const TDynamicVector<T>& v, TReductionMode mode = TReductionMode::Fast)
+{
+  typedef typename tmatrix_detail::TAccumulator<T>::type A;
+  return tmatrix_detail::reduce<A>(v.size(), tmatrix_detail::reductionBlock, mode,
+      [&](size_t first, size_t last) { return tmatrix_detail::maxAbsBlock<A>(v.data() + first, last - first); },
+      tmatrix_detail::maxPartials<A>);
+}
+
+// индекс первого наибольшего элемента
+template<typename T>
+size_t argmax(const TDynamicVector<T>& v)
+{
+  const T* x = v.data();
+  return tmatrix_detail::reduce<size_t>(v.size(), tmatrix_detail::reductionBlock, TReductionMode::Fast,
+      [&](size_t first, size_t last) { return first + tmatrix_detail::extremumBlock(x + first, last - first, std::less<T>()); },
+      [&](size_t a, size_t b) { return x[a] < x[b] ? b : a; });
+}
+
+template<typename T>
+T max(const TDynamicVector<T>& v)
+{
+  return v[argmax(v)];
+}
+
+template<typename T>
+T min(const TDynamicVector<T>& v)
+{
+  const T* x = v.data();
+  return x[tmatrix_detail::reduce<size_t>(v.size(), tmatrix_detail::reductionBlock, TReductionMode::Fast,
+      [&](size_t first, size_t last) { return first + tmatrix_detail::extremumBlock(x + first, last - first, std::greater<T>()); },
+      [&](size_t a, size_t b) { return x[b] < x[a] ? b : a; })];
+}
+
+// Свёртки матриц: строки обрабатываются кусками примерно по
+// reductionBlock элементов
+template<typename T>
+typename tmatrix_detail::TAccumulator<T>::type sum(const TDynamicMatrix<T>& m, TReductionMode mode = TReductionMode::Fast)
+{
+  typedef typename tmatrix_detail::TAccumulator<T>::type A;
+  return tmatrix_detail::reduce<A>(m.rows(), tmatrix_detail::reductionRows(m.cols()), mode,
+      [&](size_t first, size_t last)
+      {
+          A s = A();
+          for (size_t i = first; i < last; i++)
+              s += tmatrix_detail::sumBlock<A>(m[i].data(), m.cols());
+          return s;
+      },
+      tmatrix_detail::addPartials<A>);
+}
+
+template<typename T>
+auto frobenius(const TDynamicMatrix<T>& m, TReductionMode mode = TReductionMode::Fast)
+    -> decltype(std::sqrt(typename tmatrix_detail::TAccumulator<T>::type()))
+{
+  typedef typename tmatrix_detail::TAccumulator<T>::type A;
+  return std::sqrt(tmatrix_detail::reduce<A>(m.rows(), tmatrix_detail::reductionRows(m.cols()), mode,
+      [&](size_t first, size_t last)
+      {
+          A s = A();
+          for (size_t i = first; i < last; i++)
+              s += tmatrix_detail::squareSumBlock<A>(m[i].data(), m.cols());
+          return s;
+      },
+      tmatrix_detail::addPartials<A>));
+}
+
+// подчинённая норма: наибольшая сумма модулей по столбцам
+template<typename T>
+typename tmatrix_detail::TAccumulator<T>::type norm1(const TDynamicMatrix<T>& m, TReductionMode mode = TReductionMode::Fast)
+{
+  typedef typename tmatrix_detail::TAccumulator<T>::type A;
+  const size_t n = m.cols();
+  TDynamicVector<A> sums = tmatrix_detail::reduce<TDynamicVector<A>>(m.rows(), tmatrix_detail::reductionRows(n), mode,
+      [&](size_t first, size_t last)
+      {
+          TDynamicVector<A> s(n);
+          for (size_t i = first; i < last; i++)
+          {
+              const T* mi = m[i].data();
+              for (size_t j = 0; j < n; j++)
+                  s[j] += tmatrix_detail::absValue(A(mi[j]));
+          }
+          return s;
+      },
+      [&](const TDynamicVector<A>& x, const TDynamicVector<A>& y)
+      {
+          TDynamicVector<A> s(x);
+          for (size_t j = 0; j < n; j++)
+              s[j] += y[j];
+          return s;
+      });
+  return tmatrix_detail::maxAbsBlock<A>(sums.data(), n);
+}
+
+// подчинённая норма: наибольшая сумма модулей по строкам
+template<typename T>
+typename tmatrix_detail::TAccumulator<T>::type normInf(const TDynamicMatrix<T>& m, TReductionMode mode = TReductionMode::Fast)
+{
+  typedef typename tmatrix_detail::TAccumulator<T>::type A;
+  return tmatrix_detail::reduce<A>(m.rows(), tmatrix_detail::reductionRows(m.cols()), mode,
+      [&](size_t first, size_t last)
+      {
+          A r = A();
+          for (size_t i = first; i < last; i++)
+              r = std::max(r, tmatrix_detail::absSumBlock<A>(m[i].data(), m.cols()));
+          return r;
+      },
+      tmatrix_detail::maxPartials<A>);
+}
+
+// (строка, столбец) первого наибольшего элемента в построчном порядке
+template<typename T>
+std::pair<size_t, size_t> argmax(const TDynamicMatrix<T>& m)
+{
+  const size_t n = m.cols();
+  auto at = [&](size_t k) -> const T& { return m[k / n][k % n]; };
+  const size_t k = tmatrix_detail::reduce<size_t>(m.rows(), tmatrix_detail::reductionRows(n), TReductionMode::Fast,
+      [&](size_t first, size_t last)
+      {
+          size_t best = first * n + tmatrix_detail::extremumBlock(m[first].data(), n, std::less<T>());
+          for (size_t i = first + 1; i < last; i++)
+          {
+              const size_t j = tmatrix_detail::extremumBlock(m[i].data(), n, std::less<T>());
+              if (at(best) < m[i][j])
+                  best = i * n + j;
+          }
+          return best;
+      },
+      [&](size_t a, size_t b) { return at(a) < at(b) ? b : a; });
+  return std::make_pair(k / n, k % n);
+}
+
+template<typename T>
+T max(const TDynamicMatrix<T>& m)
+{
+  const std::pair<size_t, size_t> k = argmax(m);
+  return m[k.first][k.second];
+}
+
+template<typename T>
+T min(const TDynamicMatrix<T>& m)
+{
+  const size_t n = m.cols();
+  return tmatrix_detail::reduce<T>(m.rows(), tmatrix_detail::reductionRows(n), TReductionMode::Fast,
+      [&](size_t first, size_t last)
+      {
+          T res = m[first][tmatrix_detail::extremumBlock(m[first].data(), n, std::greater<T>())];
+          for (size_t i = first + 1; i < last; i++)
+          {
+              const T& r = m[i][tmatrix_detail::extremumBlock(m[i].data(), n, std::greater<T>())];
+              if (r < res)
+                  res = r;
+          }
+          return res;
+      },
+      [&](const T& a, const T& b) { return b < a ? b : a; });
+}
+
+// Возведение квадратной матрицы в степень бинарным методом слева направо
+// (по битам k от старшего к младшему). Используются два буфера - результат
+// и вспомогательный, между которыми меняются местами произведения; A
+// читается на месте. Для T требуются T(0), T(1), += и *, поэтому
+// подходят и типы модульной арифметики.
+template<typename T>
+TDynamicMatrix<T> pow(const TDynamicMatrix<T>& a, uint64_t k)
+{
+  const size_t n = a.size();
+  if (a.cols() != n)
+      throw length_error("matrix must be square");
+  if (k == 0)
+  {
+      TDynamicMatrix<T> res(n);
+      for (size_t i = 0; i < n; i++)
+          res[i][i] = T(1);
+      return res;
+  }
+
+  uint64_t bit = uint64_t(1) << 63;
+  while ((k & bit) == 0)
+      bit >>= 1;
+  TDynamicMatrix<T> res(a), tmp(n);
+  for (bit >>= 1; bit != 0; bit >>= 1)
+  {
+      multiply(res, res, tmp);
+      if (k & bit)
+          multiply(tmp, a, res);
+      else
+          swap(res, tmp);
+  }
+  return res;
+}
+
+// y = A^T * x без выделения памяти под результат. Строки разбиваются на
+// блоки фиксированного размера, частичные суммы блоков складываются
+// в фиксированном порядке - результат не зависит от числа потоков
+template<typename T>
+void multiplyTransposed(const TDynamicMatrix<T>& a, const TDynamicVector<T>& x, TDynamicVector<T>& y)
+{
+  const size_t m = a.rows();
+  const size_t n = a.cols();
+  if (x.size() != m || y.size() != n)
+      throw length_error("length error");
+  const size_t rowBlock = 1024;
+  const size_t blocks = (m + rowBlock - 1) / rowBlock;
+  std::vector<T> partial(blocks * n, T());
+  tmatrix_detail::parallelFor(0, blocks, 1, [&](size_t first, size_t last)
+  {
+      for (size_t b = first; b < last; b++)
+      {
+          T* pb = partial.data() + b * n;
+          for (size_t i = b * rowBlock; i < std::min(m, (b + 1) * rowBlock); i++)
+              tmatrix_detail::axpy(x[i], a[i].data(), pb, n);
+      }
+  });
+  tmatrix_detail::parallelFor(0, n, 4096, [&](size_t c0, size_t c1)
+  {
+      for (size_t c = c0; c < c1; c++)
+      {
+          T sum = T();
+          for (size_t b = 0; b < blocks; b++)
+              sum += partial[b * n + c];
+          y[c] = sum;
+      }
+  });
+}
+
+// Параметры итерационных методов: остановка при ||r|| <= tolerance * ||b||
+template<typename T>
+struct TIterativeOptions
+{
+  size_t maxIterations = 1000;
+  T tolerance = T(1e-10);
+};
+
+template<typename T>
+struct TIterativeResult
+{
+  size_t iterations;
+  T residual;     // ||b - A * x||
+  bool converged;
+};
+
+namespace tmatrix_detail
+{
+  // оператор - либо матрица, либо функтор op(x, y), вычисляющий y = A * x
+  template<typename T>
+  void applyOperator(const TDynamicMatrix<T>& a, const TDynamicVector<T>& x, TDynamicVector<T>& y)
+  {
+      multiply(a, x, y);
+  }
+
+  template<typename Op, typename T>
+  void applyOperator(const Op& op, const TDynamicVector<T>& x, TDynamicVector<T>& y)
+  {
+      op(x, y);
+  }
+
+  // x += alpha * p, r -= alpha * q; возвращает r * r
+  template<typename T>
+  T updateSolutionAndResidual(T alpha, const T* p, const T* q, T* x, T* r, size_t n) noexcept
+  {
+      T s0 = T(), s1 = T();
+      size_t i = 0;
+      for (; i + 2 <= n; i += 2)
+      {
+          x[i] += alpha * p[i];
+          x[i + 1] += alpha * p[i + 1];
+          r[i] -= alpha * q[i];
+          r[i + 1] -= alpha * q[i + 1];
+          s0 += r[i] * r[i];
+          s1 += r[i + 1] * r[i + 1];
+      }
+      for (; i < n; i++)
+      {
+          x[i] += alpha * p[i];
+          r[i] -= alpha * q[i];
+          s0 += r[i] * r[i];
+      }
+      return s0 + s1;
+  }
+
+  // z = x - alpha * y; возвращает z * z
+  template<typename T>
+  T subtractScaledAndNorm(const T* x, T alpha, const T* y, T* z, size_t n) noexcept
+  {
+      T s = T();
+      for (size_t i = 0; i < n; i++)
+      {
+          z[i] = x[i] - alpha * y[i];
+          s += z[i] * z[i];
+      }
+      return s;
+  }
+
+  // x * y и y * y за один проход
+  template<typename T>
+  void dotPair(const T* x, const T* y, size_t n, T& xy, T& yy) noexcept
+  {
+      T a = T(), b = T();
+      for (size_t i = 0; i < n; i++)
+      {
+          a += x[i] * y[i];
+          b += y[i] * y[i];
+      }
+      xy = a;
+      yy = b;
+  }
+
+  template<typename T>
+  struct TContinueIterations
+  {
+      bool operator()(size_t, T) const noexcept { return true; }
+  };
+}
+
+// Метод сопряжённых градиентов для симметричного положительно определённого
+// оператора. x - начальное приближение и результат. Все рабочие векторы
+// выделяются один раз до начала итераций. callback(iteration, ||r||)
+// вызывается на каждой итерации; возврат false прекращает итерации.
+template<typename Op, typename T, typename Callback>
+TIterativeResult<T> conjugateGradient(Op&& a, const TDynamicVector<T>& b, TDynamicVector<T>& x,
+    const TIterativeOptions<T>& options, Callback callback)
+{
+  const size_t n = b.size();
+  if (x.size() != n)
+      throw length_error("length error");
+
+  TDynamicVector<T> r(n), p(n), q(n);
+  tmatrix_detail::applyOperator(a, x, q);
+  T rr = tmatrix_detail::subtractScaledAndNorm(b.data(), T(1), q.data(), r.data(), n);
+  std::copy(r.data(), r.data() + n, p.data());
+
+  const T bnorm = std::sqrt(tmatrix_detail::dot(b.data(), b.data(), n));
+  const T threshold = options.tolerance * (bnorm > T(0) ? bnorm : T(1));
+  TIterativeResult<T> res{ 0, std::sqrt(rr), false };
+
+  while (res.residual > threshold && res.iterations < options.maxIterations)
+  {
+      tmatrix_detail::applyOperator(a, p, q);
+      const T pq = tmatrix_detail::dot(p.data(), q.data(), n);
+      if (pq == T(0))
+          break;
+      const T alpha = rr / pq;
+      const T rrNew = tmatrix_detail::updateSolutionAndResidual(alpha, p.data(), q.data(), x.data(), r.data(), n);
+      res.iterations++;
+      res.residual = std::sqrt(rrNew);
+      if (!callback(res.iterations, res.residual))
+          break;
+
+      const T beta = rrNew / rr;
+      rr = rrNew;
+      T* pp = p.data();
+      const T* pr = r.data();
+      for (size_t i = 0; i < n; i++)
+          pp[i] = pr[i] + beta * pp[i];
+  }
+  res.converged = res.residual <= threshold;
+  return res;
+}
+
+template<typename Op, typename T>
+TIterativeResult<T> conjugateGradient(Op&& a, const TDynamicVector<T>& b, TDynamicVector<T>& x,
+    const TIterativeOptions<T>& options = TIterativeOptions<T>())
+{
+  return conjugateGradient(std::forward<Op>(a), b, x, options, tmatrix_detail::TContinueIterations<T>());
+}
+
+// Стабилизированный метод бисопряжённых градиентов (BiCGSTAB)
+// для произвольного невырожденного оператора
+template<typename Op, typename T, typename Callback>
+TIterativeResult<T> biCGStab(Op&& a, const TDynamicVector<T>& b, TDynamicVector<T>& x,
+    const TIterativeOptions<T>& options, Callback callback)
+{
+  const size_t n = b.size();
+  if (x.size() != n)
+      throw length_error("length error");
+
+  TDynamicVector<T> r(n), rhat(n), p(n), v(n), s(n), t(n);
+  tmatrix_detail::applyOperator(a, x, v);
+  T rr = tmatrix_detail::subtractScaledAndNorm(b.data(), T(1), v.data(), r.data(), n);
+  std::copy(r.data(), r.data() + n, rhat.data());
+  std::fill(v.data(), v.data() + n, T(0));
+
+  const T bnorm = std::sqrt(tmatrix_detail::dot(b.data(), b.data(), n));
+  const T threshold = options.tolerance * (bnorm > T(0) ? bnorm : T(1));
+  TIterativeResult<T> res{ 0, std::sqrt(rr), false };
+  T rho = T(1), alpha = T(1), omega = T(1);
+
+  while (res.residual > threshold && res.iterations < options.maxIterations)
+  {
+      const T rhoNew = tmatrix_detail::dot(rhat.data(), r.data(), n);
+      if (rhoNew == T(0))
+          break;
+      const T beta = (rhoNew / rho) * (alpha / omega);
+      rho = rhoNew;
+      T* pp = p.data();
+      const T* pr = r.data();
+      const T* pv = v.data();
+      for (size_t i = 0; i < n; i++)
+          pp[i] = pr[i] + beta * (pp[i] - omega * pv[i]);
+
+      tmatrix_detail::applyOperator(a, p, v);
+      const T rv = tmatrix_detail::dot(rhat.data(), v.data(), n);
+      if (rv == T(0))
+          break;
+      alpha = rho / rv;
+      const T ss = tmatrix_detail::subtractScaledAndNorm(r.data(), alpha, v.data(), s.data(), n);
+      res.iterations++;
+      if (std::sqrt(ss) <= threshold)
+      {
+          tmatrix_detail::axpy(alpha, p.data(), x.data(), n);
+          res.residual = std::sqrt(ss);
+          callback(res.iterations, res.residual);
+          break;
+      }
+
+      tmatrix_detail::applyOperator(a, s, t);
+      T ts, tt;
+      tmatrix_detail::dotPair(s.data(), t.data(), n, ts, tt);
+      if (tt == T(0))
+          break;
+      omega = ts / tt;
+      T* px = x.data();
+      const T* ps = s.data();
+      for (size_t i = 0; i < n; i++)
+          px[i] += alpha * pp[i] + omega * ps[i];
+      rr = tmatrix_detail::subtractScaledAndNorm(s.data(), omega, t.data(), r.data(), n);
+      res.residual = std::sqrt(rr);
+      if (!callback(res.iterations, res.residual) || omega == T(0))
+          break;
+  }
+  res.converged = res.residual <= threshold;
+  return res;
+}
+
+template<typename Op, typename T>
+TIterativeResult<T> biCGStab(Op&& a, const TDynamicVector<T>& b, TDynamicVector<T>& x,
+    const TIterativeOptions<T>& options = TIterativeOptions<T>())
+{
+  return biCGStab(std::forward<Op>(a), b, x, options, tmatrix_detail::TContinueIterations<T>());
+}
+
+namespace tmatrix_detail
+{
+  // тип для промежуточных произведений в алгоритме Барейса
+  template<typename T>
+  struct TWideInteger
+  {
+      typedef long long type;
+  };
+
+#ifdef __SIZEOF_INT128__
+  template<>
+  struct TWideInteger<long long>
+  {
+      typedef __int128 type;
+  };
+
+  template<>
+  struct TWideInteger<long>
+  {
+      typedef __int128 type;
+  };
+
+  template<>
+  struct TWideInteger<unsigned long long>
+  {
+      typedef __int128 type;
+  };
+
+  template<>
+  struct TWideInteger<unsigned long>
+  {
+      typedef __int128 type;
+  };
+#endif
+
+  // определитель через LU-разложение
+  template<typename T>
+  T determinant(const TDynamicMatrix<T>& a, std::false_type)
+  {
+      TDynamicMatrix<T> f(a);
+      TDynamicVector<size_t> pivots;
+      const int sign = lu(f, pivots);
+      if (sign == 0)
+          return T(0);
+      T res = T(sign);
+      for (size_t i = 0; i < f.size(); i++)
+          res *= f[i][i];
+      return res;
+  }
+
+  // Точный определитель целочисленной матрицы методом Барейса:
+  // исключение без дробей, все деления нацело
+  template<typename T>
+  T determinant(const TDynamicMatrix<T>& a, std::true_type)
+  {
+      typedef typename TWideInteger<T>::type W;
+      const size_t n = a.size();
+      if (a.cols() != n)
+          throw length_error("matrix must be square");
+      TDynamicMatrix<T> m(a);
+      bool negative = false;
+      T prev = T(1);
+
+      for (size_t k = 0; k + 1 < n; k++)
+      {
+          if (m[k][k] == T(0))
+          {
+              size_t p = k + 1;
+              while (p < n && m[p][k] == T(0))
+                  p++;
+              if (p == n)
+                  return T(0);
+              swap(m[k], m[p]);
+              negative = !negative;
+          }
+          const T* mk = m[k].data();
+          const W pivot = mk[k];
+          parallelFor(k + 1, n, 8, [&](size_t first, size_t last)
+          {
+              for (size_t i = first; i < last; i++)
+              {
+                  T* mi = m[i].data();
+                  const W mik = mi[k];
+                  for (size_t j = k + 1; j < n; j++)
+                      mi[j] = T((W(mi[j]) * pivot - mik * W(mk[j])) / W(prev));
+                  mi[k] = T(0);
+              }
+          });
+          prev = mk[k];
+      }
+      return negative ? T(-m[n - 1][n - 1]) : m[n - 1][n - 1];
+  }
+}
+
+// Определитель: для целых типов - точный (метод Барейса),
+// для вещественных - через блочное LU-разложение
+template<typename T>
+T det(const TDynamicMatrix<T>& a)
+{
+  return tmatrix_detail::determinant(a, std::is_integral<T>());
+}
+
+namespace tmatrix_detail
+{
+  // перестановка столбцов j и p во всех строках
+  template<typename T>
+  void swapColumns(TDynamicMatrix<T>& a, size_t j, size_t p)
+  {
+      parallelFor(0, a.size(), 256, [&](size_t first, size_t last)
+      {
+          for (size_t i = first; i < last; i++)
+              std::swap(a[i][j], a[i][p]);
+      });
+  }
+
+  // Обращение верхнетреугольной матрицы на месте по блокам столбцов
+  template<typename T>
+  void invertUpperInPlace(TDynamicMatrix<T>& a)
+  {
+      const size_t n = a.size();
+      for (size_t j0 = 0; j0 < n; j0 += MATRIX_BLOCK_SIZE)
+      {
+          const size_t j1 = std::min(j0 + MATRIX_BLOCK_SIZE, n);
+          const size_t nb = j1 - j0;
+
+          // A12 = inv(U11) * U12, столбцы блока обрабатываются параллельно
+          parallelFor(j0, j1, 8, [&](size_t c0, size_t c1)
+          {
+              for (size_t i = 0; i < j0; i++)
+              {
+                  T* ai = a[i].data();
+                  for (size_t c = c0; c < c1; c++)
+                      ai[c] *= ai[i];
+                  for (size_t k = i + 1; k < j0; k++)
+                      axpy(ai[k], a[k].data() + c0, ai + c0, c1 - c0);
+              }
+          });
+
+          // обращение диагонального блока
+          for (size_t j = j0; j < j1; j++)
+          {
+              T* aj = a[j].data();
+              if (aj[j] == T(0))
+                  throw domain_error("matrix is singular");
+              aj[j] = T(1) / aj[j];
+              const T ajj = -aj[j];
+              for (size_t i = j0; i < j; i++)
+              {
+                  T* ai = a[i].data();
+                  T s = T(0);
+                  for (size_t k = i; k < j; k++)
+                      s += ai[k] * a[k][j];
+                  ai[j] = s * ajj;
+              }
+          }
+
+          // A12 = -A12 * inv(U22), строки независимы
+          parallelFor(0, j0, 16, [&](size_t first, size_t last)
+          {
+              for (size_t i = first; i < last; i++)
+              {
+                  T* r = a[i].data() + j0;
+                  for (size_t c = nb; c-- > 0;)
+                  {
+                      T s = T(0);
+                      for (size_t k = 0; k <= c; k++)
+                          s += r[k] * a[j0 + k][j0 + c];
+                      r[c] = -s;
+                  }
+              }
+          });
+      }
+  }
+
+  // inv(A) = inv(U) * inv(L) * P: после обращения U решается
+  // inv(A) * L = inv(U) по столбцам справа налево с вектором длины n
+  template<typename T>
+  void invertLU(TDynamicMatrix<T>& a)
+  {
+      static_assert(std::is_floating_point<T>::value, "inversion requires floating point type");
+      const size_t n = a.size();
+      TDynamicVector<size_t> pivots;
+      if (lu(a, pivots) == 0)
+          throw domain_error("matrix is singular");
+      invertUpperInPlace(a);
+
+      TDynamicVector<T> work(n);
+      for (size_t j = n; j-- > 0;)
+      {
+          for (size_t i = j + 1; i < n; i++)
+          {
+              work[i] = a[i][j];
+              a[i][j] = T(0);
+          }
+          if (j + 1 == n)
+              continue;
+          parallelFor(0, n, 32, [&](size_t first, size_t last)
+          {
+              for (size_t r = first; r < last; r++)
+              {
+                  T* ar = a[r].data();
+                  ar[j] -= dot(ar + j + 1, work.data() + j + 1, n - j - 1);
+              }
+          });
+      }
+
+      for (size_t j = n; j-- > 0;)
+          if (pivots[j] != j)
+              swapColumns(a, j, pivots[j]);
+  }
+
+  // Метод Гаусса-Жордана на месте: обратная матрица строится
+  // на месте исходной, запоминаются только номера ведущих строк
+  template<typename T>
+  void invertGaussJordan(TDynamicMatrix<T>& a)
+  {
+      static_assert(std::is_floating_point<T>::value, "inversion requires floating point type");
+      const size_t n = a.size();
+      if (a.cols() != n)
+          throw length_error("matrix must be square");
+      TDynamicVector<size_t> pivots(n);
+      for (size_t k = 0; k < n; k++)
+      {
+          size_t p = k;
+          for (size_t i = k + 1; i < n; i++)
+              if (std::abs(a[i][k]) > std::abs(a[p][k]))
+                  p = i;
+          if (a[p][k] == T(0))
+              throw domain_error("matrix is singular");
+          pivots[k] = p;
+          if (p != k)
+              swap(a[p], a[k]);
+
+          T* ak = a[k].data();
+          const T inv = T(1) / ak[k];
+          ak[k] = T(1);
+          for (size_t j = 0; j < n; j++)
+              ak[j] *= inv;
+          parallelFor(0, n, 16, [&](size_t first, size_t last)
+          {
+              for (size_t i = first; i < last; i++)
+              {
+                  if (i == k)
+                      continue;
+                  T* ai = a[i].data();
+                  const T f = ai[k];
+                  ai[k] = T(0);
+                  axpy(-f, ak, ai, n);
+              }
+          });
+      }
+
+      for (size_t k = n; k-- > 0;)
+          if (pivots[k] != k)
+              swapColumns(a, k, pivots[k]);
+  }
+}
+
+// Собственные пары: values[i] - собственное число, vectors[i] - вектор
+template<typename T>
+struct TEigenPairs
+{
+  TDynamicVector<T> values;
+  TDynamicVector<TDynamicVector<T>> vectors;
+};
+
+// Степенной метод: x - начальное приближение, на выходе - нормированный
+// собственный вектор доминирующего собственного числа, которое возвращается.
+// Остановка при ||A * x - lambda * x|| <= tolerance * |lambda|.
+template<typename Op, typename T>
+T powerIteration(Op&& a, TDynamicVector<T>& x, const TIterativeOptions<T>& options = TIterativeOptions<T>())
+{
+  const size_t n = x.size();
+  T norm = std::sqrt(tmatrix_detail::dot(x.data(), x.data(), n));
+  if (norm == T(0))
+  {
+      std::fill(x.data(), x.data() + n, T(1));
+      norm = std::sqrt(T(n));
+  }
+  for (size_t i = 0; i < n; i++)
+      x[i] /= norm;
+
+  TDynamicVector<T> y(n);
+  T lambda = T(0);
+  for (size_t it = 0; it < options.maxIterations; it++)
+  {
+      tmatrix_detail::applyOperator(a, x, y);
+      lambda = tmatrix_detail::dot(x.data(), y.data(), n);
+      T residual = T(0), ynorm = T(0);
+      for (size_t i = 0; i < n; i++)
+      {
+          const T d = y[i] - lambda * x[i];
+          residual += d * d;
+          ynorm += y[i] * y[i];
+      }
+      if (ynorm == T(0))
+          return T(0);
+      ynorm = std::sqrt(ynorm);
+      for (size_t i = 0; i < n; i++)
+          x[i] = y[i] / ynorm;
+      if (std::sqrt(residual) <= options.tolerance * std::abs(lambda))
+          break;
+  }
+  return lambda;
+}
+
+// Параллельный циклический метод Якоби для симметричной матрицы.
+// Пары (p, q) перебираются по круговой схеме: на каждом шаге n/2
+// непересекающихся вращений применяются одновременно. Остановка, когда
+// норма внедиагональной части <= tolerance * ||A||; maxIterations - число
+// проходов. Собственные числа упорядочены по убыванию.
+template<typename T>
+TEigenPairs<T> jacobiEigen(const TDynamicMatrix<T>& m, const TIterativeOptions<T>& options = TIterativeOptions<T>())
+{
+  static_assert(std::is_floating_point<T>::value, "jacobiEigen requires floating point type");
+  const size_t n = m.size();
+  if (m.cols() != n)
+      throw length_error("matrix must be square");
+  TDynamicMatrix<T> a(m), v(n);
+  for (size_t i = 0; i < n; i++)
+      v[i][i] = T(1);
+
+  // круговая схема для чётного числа участников; фиктивный участник n
+  const size_t players = n + (n % 2);
+  const size_t pairCount = players / 2;
+  std::vector<size_t> order(players);
+  for (size_t i = 0; i < players; i++)
+      order[i] = i;
+  std::vector<size_t> ps(pairCount), qs(pairCount);
+  std::vector<T> cs(pairCount), sn(pairCount);
+  const size_t pairGrain = std::max<size_t>(1, 4096 / players);
+  const size_t rowGrain = std::max<size_t>(1, 4096 / players);
+
+  T total = T(0);
+  for (size_t i = 0; i < n; i++)
+      total += tmatrix_detail::dot(a[i].data(), a[i].data(), n);
+  const T threshold = options.tolerance * std::sqrt(total);
+
+  for (size_t sweep = 0; sweep < options.maxIterations; sweep++)
+  {
+      T off = T(0);
+      for (size_t i = 0; i < n; i++)
+          for (size_t j = 0; j < n; j++)
+              if (i != j)
+                  off += a[i][j] * a[i][j];
+      if (std::sqrt(off) <= threshold)
+          break;
+
+      for (size_t round = 0; round + 1 < players; round++)
+      {
+          for (size_t k = 0; k < pairCount; k++)
+          {
+              ps[k] = std::min(order[k], order[players - 1 - k]);
+              qs[k] = std::max(order[k], order[players - 1 - k]);
+          }
+          std::rotate(order.begin() + 1, order.end() - 1, order.end());
+
+          // параметры вращений зависят только от своих пар
+          for (size_t k = 0; k < pairCount; k++)
+          {
+              const size_t p = ps[k], q = qs[k];
+              cs[k] = T(1);
+              sn[k] = T(0);
+              if (q >= n || a[p][q] == T(0))
+                  continue;
+              const T tau = (a[q][q] - a[p][p]) / (T(2) * a[p][q]);
+              const T t = (tau >= T(0) ? T(1) : T(-1)) / (std::abs(tau) + std::sqrt(T(1) + tau * tau));
+              cs[k] = T(1) / std::sqrt(T(1) + t * t);
+              sn[k] = t * cs[k];
+          }
+
+          // A = J^T * A: пары строк независимы
+          tmatrix_detail::parallelFor(0, pairCount, pairGrain, [&](size_t first, size_t last)
+          {
+              for (size_t k = first; k < last; k++)
+              {
+                  if (sn[k] == T(0))
+                      continue;
+                  T* ap = a[ps[k]].data();
+                  T* aq = a[qs[k]].data();
+                  const T c = cs[k], s = sn[k];
+                  for (size_t j = 0; j < n; j++)
+                  {
+                      const T x = ap[j], y = aq[j];
+                      ap[j] = c * x - s * y;
+                      aq[j] = s * x + c * y;
+                  }
+              }
+          });
+
+          // A = A * J и V = V * J: строки независимы
+          tmatrix_detail::parallelFor(0, n, rowGrain, [&](size_t first, size_t last)
+          {
+              for (size_t i = first; i < last; i++)
+              {
+                  T* ai = a[i].data();
+                  T* vi = v[i].data();
+                  for (size_t k = 0; k < pairCount; k++)
+                  {
+                      if (sn[k] == T(0))
+                          continue;
+                      const size_t p = ps[k], q = qs[k];
+                      const T c = cs[k], s = sn[k];
+                      T x = ai[p], y = ai[q];
+                      ai[p] = c * x - s * y;
+                      ai[q] = s * x + c * y;
+                      x = vi[p];
+                      y = vi[q];
+                      vi[p] = c * x - s * y;
+                      vi[q] = s * x + c * y;
+                  }
+              }
+          });
+
+          for (size_t k = 0; k < pairCount; k++)
+              if (sn[k] != T(0))
+                  a[ps[k]][qs[k]] = a[qs[k]][ps[k]] = T(0);
+      }
+  }
+
+  std::vector<size_t> idx(n);
+  for (size_t i = 0; i < n; i++)
+      idx[i] = i;
+  std::sort(idx.begin(), idx.end(), [&](size_t l, size_t r) { return a[l][l] > a[r][r]; });
+
+  TEigenPairs<T> res{ TDynamicVector<T>(n), TDynamicVector<TDynamicVector<T>>(n) };
+  for (size_t k = 0; k < n; k++)
+  {
+      res.values[k] = a[idx[k]][idx[k]];
+      res.vectors[k] = TDynamicVector<T>(n);
+      for (size_t i = 0; i < n; i++)
+          res.vectors[k][i] = v[i][idx[k]];
+  }
+  return res;
+}
+
+// Метод Ланцоша с полной переортогонализацией: k собственных пар
+// симметричного оператора, наибольших по модулю. start - начальный вектор,
+// steps - размер подпространства Крылова (0 - выбирается автоматически).
+template<typename Op, typename T>
+TEigenPairs<T> lanczos(Op&& a, const TDynamicVector<T>& start, size_t k, size_t steps = 0)
+{
+  static_assert(std::is_floating_point<T>::value, "lanczos requires floating point type");
+  const size_t n = start.size();
+  if (k == 0 || k > n)
+      throw out_of_range("out_of_range");
+  if (steps == 0)
+      steps = std::max(4 * k, k + 30);
+  steps = std::min(std::max(steps, k), n);
+
+  TDynamicVector<TDynamicVector<T>> q(steps);
+  TDynamicVector<T> w(n), alpha(steps), beta(steps);
+  T norm = std::sqrt(tmatrix_detail::dot(start.data(), start.data(), n));
+  q[0] = start;
+  if (norm == T(0))
+  {
+      std::fill(q[0].data(), q[0].data() + n, T(1));
+      norm = std::sqrt(T(n));
+  }
+  for (size_t i = 0; i < n; i++)
+      q[0][i] /= norm;
+
+  size_t m = steps;
+  for (size_t j = 0; j < steps; j++)
+  {
+      tmatrix_detail::applyOperator(a, q[j], w);
+      alpha[j] = tmatrix_detail::dot(q[j].data(), w.data(), n);
+      // полная переортогонализация (дважды для устойчивости)
+      for (int pass = 0; pass < 2; pass++)
+          for (size_t i = 0; i <= j; i++)
+              tmatrix_detail::axpy(-tmatrix_detail::dot(q[i].data(), w.data(), n), q[i].data(), w.data(), n);
+      if (j + 1 == steps)
+          break;
+      beta[j] = std::sqrt(tmatrix_detail::dot(w.data(), w.data(), n));
+      if (beta[j] <= std::numeric_limits<T>::epsilon() * (std::abs(alpha[j]) + (j > 0 ? beta[j - 1] : T(0))))
+      {
+          m = j + 1;
+          break;
+      }
+      q[j + 1] = TDynamicVector<T>(n);
+      for (size_t i = 0; i < n; i++)
+          q[j + 1][i] = w[i] / beta[j];
+  }
+  if (k > m)
+      k = m;
+
+  // собственные пары трёхдиагональной матрицы Ланцоша
+  TDynamicMatrix<T> t(m);
+  for (size_t j = 0; j < m; j++)
+  {
+      t[j][j] = alpha[j];
+      if (j + 1 < m)
+          t[j][j + 1] = t[j + 1][j] = beta[j];
+  }
+  TIterativeOptions<T> options;
+  options.tolerance = std::numeric_limits<T>::epsilon();
+  options.maxIterations = 100;
+  TEigenPairs<T> ritz = jacobiEigen(t, options);
+
+  std::vector<size_t> idx(m);
+  for (size_t i = 0; i < m; i++)
+      idx[i] = i;
+  std::sort(idx.begin(), idx.end(), [&](size_t l, size_t r) { return std::abs(ritz.values[l]) > std::abs(ritz.values[r]); });
+
+  TEigenPairs<T> res{ TDynamicVector<T>(k), TDynamicVector<TDynamicVector<T>>(k) };
+  for (size_t e = 0; e < k; e++)
+  {
+      const TDynamicVector<T>& s = ritz.vectors[idx[e]];
+      res.values[e] = ritz.values[idx[e]];
+      res.vectors[e] = TDynamicVector<T>(n);
+      for (size_t j = 0; j < m; j++)
+          tmatrix_detail::axpy(s[j], q[j].data(), res.vectors[e].data(), n);
+  }
+  return res;
+}
+
+// Сингулярные тройки: A ~ sum values[i] * left[i] * right[i]^T,
+// values упорядочены по убыванию
+template<typename T>
+struct TSingularTriplets
+{
+  TDynamicVector<T> values;
+  TDynamicVector<TDynamicVector<T>> left;
+  TDynamicVector<TDynamicVector<T>> right;
+};
+
+namespace tmatrix_detail
+{
+  // Односторонний метод Якоби: столбцы cols (каждый длины r) вращаются
+  // парами до взаимной ортогональности, вращения накапливаются в строках vt.
+  // Непересекающиеся пары каждого шага круговой схемы обрабатываются параллельно.
+  template<typename T>
+  void oneSidedJacobi(TDynamicVector<TDynamicVector<T>>& cols, TDynamicVector<TDynamicVector<T>>& vt, size_t maxSweeps)
+  {
+      const size_t c = cols.size();
+      const size_t r = cols[0].size();
+      vt = TDynamicVector<TDynamicVector<T>>(c);
+      for (size_t i = 0; i < c; i++)
+      {
+          vt[i] = TDynamicVector<T>(c);
+          vt[i][i] = T(1);
+      }
+
+      const size_t players = c + (c % 2);
+      const size_t pairCount = players / 2;
+      std::vector<size_t> order(players);
+      for (size_t i = 0; i < players; i++)
+          order[i] = i;
+      const T eps = std::numeric_limits<T>::epsilon() * T(c);
+      const size_t pairGrain = std::max<size_t>(1, 2048 / (r + c));
+
+      for (size_t sweep = 0; sweep < maxSweeps; sweep++)
+      {
+          std::atomic<size_t> rotations(0);
+          for (size_t round = 0; round + 1 < players; round++)
+          {
+              parallelFor(0, pairCount, pairGrain, [&](size_t first, size_t last)
+              {
+                  size_t local = 0;
+                  for (size_t k = first; k < last; k++)
+                  {
+                      const size_t p = std::min(order[k], order[players - 1 - k]);
+                      const size_t q = std::max(order[k], order[players - 1 - k]);
+                      if (q >= c)
+                          continue;
+                      T* wp = cols[p].data();
+                      T* wq = cols[q].data();
+                      const T alpha = dot(wp, wp, r), beta = dot(wq, wq, r), gamma = dot(wp, wq, r);
+                      if (gamma == T(0) || std::abs(gamma) <= eps * std::sqrt(alpha * beta))
+                          continue;
+                      const T zeta = (beta - alpha) / (T(2) * gamma);
+                      const T t = (zeta >= T(0) ? T(1) : T(-1)) / (std::abs(zeta) + std::sqrt(T(1) + zeta * zeta));
+                      const T cs = T(1) / std::sqrt(T(1) + t * t), sn = cs * t;
+                      for (size_t i = 0; i < r; i++)
+                      {
+                          const T x = wp[i], y = wq[i];
+                          wp[i] = cs * x - sn * y;
+                          wq[i] = sn * x + cs * y;
+                      }
+                      T* vp = vt[p].data();
+                      T* vq = vt[q].data();
+                      for (size_t i = 0; i < c; i++)
+                      {
+                          const T x = vp[i], y = vq[i];
+                          vp[i] = cs * x - sn * y;
+                          vq[i] = sn * x + cs * y;
+                      }
+                      local++;
+                  }
+                  rotations += local;
+              });
+              std::rotate(order.begin() + 1, order.end() - 1, order.end());
+          }
+          if (rotations == 0)
+              break;
+      }
+  }
+
+  // сингулярные тройки по ортогонализованным столбцам:
+  // sigma_i = ||cols[i]||, left[i] = cols[i] / sigma_i, right[i] = vt[i]
+  template<typename T>
+  TSingularTriplets<T> collectTriplets(const TDynamicVector<TDynamicVector<T>>& cols,
+      const TDynamicVector<TDynamicVector<T>>& vt, size_t k)
+  {
+      const size_t c = cols.size();
+      const size_t r = cols[0].size();
+      std::vector<T> norms(c);
+      std::vector<size_t> idx(c);
+      for (size_t i = 0; i < c; i++)
+      {
+          norms[i] = std::sqrt(dot(cols[i].data(), cols[i].data(), r));
+          idx[i] = i;
+      }
+      std::sort(idx.begin(), idx.end(), [&](size_t l, size_t rr) { return norms[l] > norms[rr]; });
+
+      TSingularTriplets<T> res{ TDynamicVector<T>(k), TDynamicVector<TDynamicVector<T>>(k), TDynamicVector<TDynamicVector<T>>(k) };
+      for (size_t e = 0; e < k; e++)
+      {
+          const size_t i = idx[e];
+          res.values[e] = norms[i];
+          res.left[e] = TDynamicVector<T>(r);
+          if (norms[i] > T(0))
+              for (size_t j = 0; j < r; j++)
+                  res.left[e][j] = cols[i][j] / norms[i];
+          res.right[e] = vt[i];
+      }
+      return res;
+  }
+
+  // ортонормирование строк матрицы (модифицированный Грам-Шмидт, два прохода)
+  template<typename T>
+  void orthonormalizeRows(TDynamicMatrix<T>& q)
+  {
+      const size_t l = q.rows();
+      const size_t m = q.cols();
+      for (size_t j = 0; j < l; j++)
+      {
+          T* qj = q[j].data();
+          for (int pass = 0; pass < 2; pass++)
+              for (size_t i = 0; i < j; i++)
+                  axpy(-dot(q[i].data(), qj, m), q[i].data(), qj, m);
+          const T norm = std::sqrt(dot(qj, qj, m));
+          if (norm > T(0))
+              for (size_t i = 0; i < m; i++)
+                  qj[i] /= norm;
+      }
+  }
+
+  // C = X * A (l x m на m x n) при малом l за один проход по A: строки A
+  // делятся между потоками, каждый кусок даёт частичную сумму l x n,
+  // частичные суммы складываются попарно
+  template<typename T>
+  void multiplyLeftThin(const TDynamicMatrix<T>& x, const TDynamicMatrix<T>& a, TDynamicMatrix<T>& c)
+  {
+      const size_t l = x.rows();
+      const size_t m = a.rows();
+      const size_t n = a.cols();
+      if (x.cols() != m || c.rows() != l || c.cols() != n)
+          throw length_error("length error");
+      TMATRIX_OPERATION(TOperation::Gemm, l * n, 2 * l * m * n, (l * m + m * n + l * n) * sizeof(T));
+      c = reduce<TDynamicMatrix<T>>(m, reductionRows(n), TReductionMode::Fast,
+          [&](size_t first, size_t last)
+          {
+              TDynamicMatrix<T> part(l, n);
+              for (size_t i = first; i < last; i++)
+              {
+                  const T* ai = a[i].data();
+                  for (size_t j = 0; j < l; j++)
+                      axpy(x[j][i], ai, part[j].data(), n);
+              }
+              return part;
+          },
+          [&](TDynamicMatrix<T> p, const TDynamicMatrix<T>& q)
+          {
+              for (size_t j = 0; j < l; j++)
+                  axpy(T(1), q[j].data(), p[j].data(), n);
+              return p;
+          });
+  }
+}
+
+// Сингулярное разложение односторонним методом Якоби
+template<typename T>
+TSingularTriplets<T> jacobiSvd(const TDynamicMatrix<T>& a, size_t maxSweeps = 60)
+{
+  static_assert(std::is_floating_point<T>::value, "jacobiSvd requires floating point type");
+  const size_t m = a.size();
+  const size_t n = a.cols();
+  TDynamicVector<TDynamicVector<T>> cols(n), vt;
+  for (size_t j = 0; j < n; j++)
+  {
+      cols[j] = TDynamicVector<T>(m);
+      for (size_t i = 0; i < m; i++)
+          cols[j][i] = a[i][j];
+  }
+  tmatrix_detail::oneSidedJacobi(cols, vt, maxSweeps);
+  return tmatrix_detail::collectTriplets(cols, vt, std::min(m, n));
+}
+
+// Рандомизированное усечённое SVD: k старших сингулярных троек.
+// Подпространство размерности k + oversampling находится несколькими
+// матричными умножениями на случайную гауссову матрицу (с powerIterations
+// степенными уточнениями), затем точно раскладывается малая матрица Q^T * A.
+template<typename T>
+TSingularTriplets<T> randomizedSvd(const TDynamicMatrix<T>& a, size_t k, size_t oversampling = 10,
+    size_t powerIterations = 2, uint64_t seed = 42)
+{
+  static_assert(std::is_floating_point<T>::value, "randomizedSvd requires floating point type");
+  const size_t m = a.size();
+  const size_t n = a.cols();
+  if (k == 0 || k > std::min(m, n))
+      throw out_of_range("out_of_range");
+  const size_t l = std::min(k + oversampling, std::min(m, n));
+
+  // базисы хранятся по строкам: Q^T (l x m) и Z^T (l x n); A * Z считается
+  // блочным gemm, A^T * Q = (Q^T * A)^T - одним проходом по строкам A
+  std::mt19937_64 gen(seed);
+  std::normal_distribution<T> dist;
+  TDynamicMatrix<T> omega(n, l), y(m, l), qt(l, m), zt(l, n);
+  for (size_t i = 0; i < n; i++)
+      for (size_t j = 0; j < l; j++)
+          omega[i][j] = dist(gen);
+
+  tmatrix_detail::gemm(a, omega, y);
+  qt = y.transpose();
+  tmatrix_detail::orthonormalizeRows(qt);
+  for (size_t it = 0; it < powerIterations; it++)
+  {
+      tmatrix_detail::multiplyLeftThin(qt, a, zt);
+      tmatrix_detail::orthonormalizeRows(zt);
+      omega = zt.transpose();
+      tmatrix_detail::gemm(a, omega, y);
+      qt = y.transpose();
+      tmatrix_detail::orthonormalizeRows(qt);
+  }
+
+  // строки B = Q^T * A - столбцы B^T; B^T = U_b * S * V_b^T
+  tmatrix_detail::multiplyLeftThin(qt, a, zt);
+  TDynamicVector<TDynamicVector<T>> bt(l), vt;
+  for (size_t j = 0; j < l; j++)
+      bt[j] = zt[j];
+  tmatrix_detail::oneSidedJacobi(bt, vt, 60);
+  TSingularTriplets<T> small = tmatrix_detail::collectTriplets(bt, vt, k);
+
+  // B = V_b * S * U_b^T, поэтому A ~ (Q * V_b) * S * U_b^T
+  TSingularTriplets<T> res{ small.values, TDynamicVector<TDynamicVector<T>>(k), small.left };
+  for (size_t e = 0; e < k; e++)
+  {
+      res.left[e] = TDynamicVector<T>(m);
+      for (size_t j = 0; j < l; j++)
+          tmatrix_detail::axpy(small.right[e][j], qt[j].data(), res.left[e].data(), m);
+  }
+  return res;
+}
+
+// Пакет квадратных матриц одного размера в общем буфере. Матрицы
+// чередуются группами по lanes штук: элементы (i, j) соседних матриц группы
+// лежат подряд, поэтому ядра обрабатывают всю группу одной векторной операцией.
+template<typename T>
+class TMatrixBatch
+{
+public:
+  static const size_t lanes = 8;
+
+private:
+  size_t count;
+  size_t dim;
+  TDynamicVector<T> mem;
+
+  size_t offset(size_t b, size_t i, size_t j) const noexcept
+  {
+      return (((b / lanes) * dim + i) * dim + j) * lanes + b % lanes;
+  }
+
+public:
+  TMatrixBatch(size_t batchSize, size_t n)
+      : count(batchSize), dim(n), mem(((batchSize + lanes - 1) / lanes) * lanes * n * n)
+  {
+      if (count == 0 || dim == 0)
+          throw out_of_range("Batch size and matrix size should be greater than zero");
+  }
+
+  size_t size() const noexcept { return count; }
+  size_t dimension() const noexcept { return dim; }
+  size_t groups() const noexcept { return (count + lanes - 1) / lanes; }
+
+  T* data() noexcept { return mem.data(); }
+  const T* data() const noexcept { return mem.data(); }
+
+  // элемент (i, j) матрицы b
+  T& operator()(size_t b, size_t i, size_t j) { return mem[offset(b, i, j)]; }
+  const T& operator()(size_t b, size_t i, size_t j) const { return mem[offset(b, i, j)]; }
+
+  void set(size_t b, const TDynamicMatrix<T>& m)
+  {
+      if (b >= count)
+          throw out_of_range("out_of_range");
+      if (m.rows() != dim || m.cols() != dim)
+          throw length_error("length error");
+      for (size_t i = 0; i < dim; i++)
+          for (size_t j = 0; j < dim; j++)
+              mem[offset(b, i, j)] = m[i][j];
+  }
+
+  TDynamicMatrix<T> get(size_t b) const
+  {
+      if (b >= count)
+          throw out_of_range("out_of_range");
+      TDynamicMatrix<T> m(dim);
+      for (size_t i = 0; i < dim; i++)
+          for (size_t j = 0; j < dim; j++)
+              m[i][j] = mem[offset(b, i, j)];
+      return m;
+  }
+};
+
+namespace tmatrix_detail
+{
+  // C = A * B для группы из L чередующихся матриц n x n
+  template<typename T, size_t L>
+  void multiplyGroup(const T* a, const T* b, T* c, size_t n) noexcept
+  {
+      for (size_t i = 0; i < n; i++)
+      {
+          T* ci = c + i * n * L;
+          std::fill(ci, ci + n * L, T());
+          for (size_t k = 0; k < n; k++)
+          {
+              const T* aik = a + (i * n + k) * L;
+              const T* bk = b + k * n * L;
+              for (size_t j = 0; j < n; j++)
+                  for (size_t l = 0; l < L; l++)
+                      ci[j * L + l] += aik[l] * bk[j * L + l];
+          }
+      }
+  }
+
+  // вариант с размером, известным при компиляции
+  template<typename T, size_t L, size_t N>
+  void multiplyGroupFixed(const T* a, const T* b, T* c) noexcept
+  {
+      for (size_t i = 0; i < N; i++)
+      {
+          T acc[N * L] = {};
+          for (size_t k = 0; k < N; k++)
+          {
+              const T* aik = a + (i * N + k) * L;
+              const T* bk = b + k * N * L;
+              for (size_t j = 0; j < N; j++)
+                  for (size_t l = 0; l < L; l++)
+                      acc[j * L + l] += aik[l] * bk[j * L + l];
+          }
+          std::copy(acc, acc + N * L, c + i * N * L);
+      }
+  }
+}
+
+// Пакетное умножение C[b] = A[b] * B[b]; группы матриц распределяются
+// между потоками, для размеров 4, 8, 16, 32 и 64 используются ядра
+// с размером, известным при компиляции
+template<typename T>
+void multiplyBatched(const TMatrixBatch<T>& a, const TMatrixBatch<T>& b, TMatrixBatch<T>& c)
+{
+  const size_t n = a.dimension();
+  if (a.size() != b.size() || a.size() != c.size() || b.dimension() != n || c.dimension() != n)
+      throw length_error("length error");
+  if (&c == &a || &c == &b)
+      throw invalid_argument("output matrix must not alias an operand");
+  const size_t L = TMatrixBatch<T>::lanes;
+  const size_t stride = n * n * L;
+  const size_t groupGrain = std::max<size_t>(1, 65536 / (stride * n));
+
+  tmatrix_detail::parallelFor(0, a.groups(), groupGrain, [&](size_t first, size_t last)
+  {
+      for (size_t g = first; g < last; g++)
+      {
+          const T* pa = a.data() + g * stride;
+          const T* pb = b.data() + g * stride;
+          T* pc = c.data() + g * stride;
+          switch (n)
+          {
+          case 4: tmatrix_detail::multiplyGroupFixed<T, L, 4>(pa, pb, pc); break;
+          case 8: tmatrix_detail::multiplyGroupFixed<T, L, 8>(pa, pb, pc); break;
+          case 16: tmatrix_detail::multiplyGroupFixed<T, L, 16>(pa, pb, pc); break;
+          case 32: tmatrix_detail::multiplyGroupFixed<T, L, 32>(pa, pb, pc); break;
+          case 64: tmatrix_detail::multiplyGroupFixed<T, L, 64>(pa, pb, pc); break;
+          default: tmatrix_detail::multiplyGroup<T, L>(pa, pb, pc, n); break;
+          }
+      }
+  });
+}
+
+namespace tmatrix_detail
+{
+  // скалярное произведение int8 с накоплением в int32. Кусок в 2^15
+  // элементов не переполняет int32 (|x * y| <= 2^14), куски суммируются
+  // в int64
+  inline int64_t dotInt8(const int8_t* x, const int8_t* y, size_t n) noexcept
+  {
+      const size_t chunk = size_t(1) << 15;
+      int64_t total = 0;
+      for (size_t i0 = 0; i0 < n; i0 += chunk)
+      {
+          const size_t i1 = std::min(i0 + chunk, n);
+          int32_t s = 0;
+          for (size_t i = i0; i < i1; i++)
+              s += int32_t(x[i]) * int32_t(y[i]);
+          total += s;
+      }
+      return total;
+  }
+}
+
+// Квантованная матрица: значения int8, у каждой строки свои масштаб s и
+// нулевая точка z, элемент равен s * (q - z). Диапазон строки расширяется
+// до нуля, чтобы нуль представлялся точно.
+class TQuantizedMatrix
+{
+  size_t nRows, nCols;
+  TDynamicVector<int8_t> values;
+  TDynamicVector<float> scales;
+  TDynamicVector<int32_t> zeroPoints;
+  TDynamicVector<int64_t> rowSums; // суммы q по строкам для учёта нулевых точек
+
+  template<typename V>
+  void quantizeRow(size_t i, const V& src)
+  {
+      float lo = 0.0f, hi = 0.0f;
+      for (size_t j = 0; j < nCols; j++)
+      {
+          lo = std::min(lo, float(src[j]));
+          hi = std::max(hi, float(src[j]));
+      }
+      float s = (hi - lo) / 255.0f;
+      if (!(s > 0.0f))
+          s = 1.0f;
+      const int32_t z = int32_t(std::max(-128.0f, std::min(127.0f, std::round(-128.0f - lo / s))));
+      int8_t* q = values.data() + i * nCols;
+      int64_t sum = 0;
+      for (size_t j = 0; j < nCols; j++)
+      {
+          const float r = std::round(float(src[j]) / s) + float(z);
+          q[j] = int8_t(std::max(-128.0f, std::min(127.0f, r)));
+          sum += q[j];
+      }
+      scales[i] = s;
+      zeroPoints[i] = z;
+      rowSums[i] = sum;
+  }
+public:
+  explicit TQuantizedMatrix(const TDynamicMatrix<float>& m)
+      : nRows(m.rows()), nCols(m.cols()), values(m.rows() * m.cols()),
+      scales(m.rows()), zeroPoints(m.rows()), rowSums(m.rows())
+  {
+      tmatrix_detail::parallelFor(0, nRows, 64, [&](size_t first, size_t last)
+      {
+          for (size_t i = first; i < last; i++)
+              quantizeRow(i, m[i]);
+      });
+  }
+
+  // вектор квантуется как матрица из одной строки
+  explicit TQuantizedMatrix(const TDynamicVector<float>& v)
+      : nRows(1), nCols(v.size()), values(v.size()), scales(1), zeroPoints(1), rowSums(1)
+  {
+      quantizeRow(0, v);
+  }
+
+  size_t rows() const noexcept { return nRows; }
+  size_t cols() const noexcept { return nCols; }
+
+  float scale(size_t i) const { return scales[i]; }
+  int32_t zeroPoint(size_t i) const { return zeroPoints[i]; }
+  int64_t rowSum(size_t i) const { return rowSums[i]; }
+
+  const int8_t* row(size_t i) const noexcept { return values.data() + i * nCols; }
+  int8_t operator()(size_t i, size_t j) const { return values[i * nCols + j]; }
+
+  float value(size_t i, size_t j) const
+  {
+      return scales[i] * float(int32_t(values[i * nCols + j]) - zeroPoints[i]);
+  }
+
+  TDynamicMatrix<float> dequantize() const
+  {
+      TDynamicMatrix<float> res(nRows, nCols);
+      for (size_t i = 0; i < nRows; i++)
+          for (size_t j = 0; j < nCols; j++)
+              res[i][j] = value(i, j);
+      return res;
+  }
+};
+
+inline TQuantizedMatrix quantize(const TDynamicMatrix<float>& m)
+{
+  return TQuantizedMatrix(m);
+}
+
+inline TDynamicMatrix<float> dequantize(const TQuantizedMatrix& q)
+{
+  return q.dequantize();
+}
+
+namespace tmatrix_detail
+{
+  // sum (a_i - za)(b_j - zb) = sum ab - zb sum a - za sum b + n za zb
+  inline int64_t quantizedDot(const TQuantizedMatrix& a, size_t i, const TQuantizedMatrix& b, size_t j) noexcept
+  {
+      const int64_t za = a.zeroPoint(i), zb = b.zeroPoint(j), n = int64_t(a.cols());
+      return dotInt8(a.row(i), b.row(j), a.cols()) - zb * a.rowSum(i) - za * b.rowSum(j) + n * za * zb;
+  }
+}
+
+// Целочисленное произведение C = (Qa - Za) * (Qb - Zb)^T: B задаётся по
+// строкам (как весовые матрицы [выходы x входы]), чтобы масштабы строк
+// обоих операндов выносились за сумму. Нулевые точки учитываются через
+// суммы строк
+inline void multiplyByTransposed(const TQuantizedMatrix& a, const TQuantizedMatrix& b, TDynamicMatrix<int64_t>& c)
+{
+  if (b.cols() != a.cols() || c.rows() != a.rows() || c.cols() != b.rows())
+      throw length_error("length error");
+  tmatrix_detail::parallelFor(0, a.rows(), 8, [&](size_t first, size_t last)
+  {
+      for (size_t i = first; i < last; i++)
+      {
+          int64_t* ci = c[i].data();
+          for (size_t j = 0; j < b.rows(); j++)
+              ci[j] = tmatrix_detail::quantizedDot(a, i, b, j);
+      }
+  });
+}
+
+// C = A * B^T в вещественных числах: каждое целочисленное скалярное
+// произведение сразу умножается на масштабы строк
+inline void multiplyByTransposed(const TQuantizedMatrix& a, const TQuantizedMatrix& b, TDynamicMatrix<float>& c)
+{
+  if (b.cols() != a.cols() || c.rows() != a.rows() || c.cols() != b.rows())
+      throw length_error("length error");
+  tmatrix_detail::parallelFor(0, a.rows(), 8, [&](size_t first, size_t last)
+  {
+      for (size_t i = first; i < last; i++)
+      {
+          const float sa = a.scale(i);
+          float* ci = c[i].data();
+          for (size_t j = 0; j < b.rows(); j++)
+              ci[j] = sa * b.scale(j) * float(tmatrix_detail::quantizedDot(a, i, b, j));
+      }
+  });
+}
+
+// y = A * x: x квантуется динамически одной строкой, результат пишется
+// прямо в y без промежуточных матриц
+inline void multiply(const TQuantizedMatrix& a, const TDynamicVector<float>& x, TDynamicVector<float>& y)
+{
+  if (a.cols() != x.size() || y.size() != a.rows())
+      throw length_error("length error");
+  const TQuantizedMatrix qx(x);
+  const float sx = qx.scale(0);
+  float* py = y.data();
+  tmatrix_detail::parallelFor(0, a.rows(), 8, [&](size_t first, size_t last)
+  {
+      for (size_t i = first; i < last; i++)
+          py[i] = a.scale(i) * sx * float(tmatrix_detail::quantizedDot(a, i, qx, 0));
+  });
+}
+
+// Симметричная матрица в упакованном виде: хранится нижний треугольник
+// по строкам, элемент (i, j), j <= i, лежит по смещению i * (i + 1) / 2 + j.
+// Обращения (i, j) и (j, i) дают один и тот же элемент
+template<typename T>
+class TSymmetricMatrix
+{
+  size_t n;
+  TDynamicVector<T> mem;
+
+  static size_t packedSize(size_t s)
+  {
+      if (s == 0 || s > getMaxVectorSize())
+          throw out_of_range("out_of_range");
+      if (s % 2 == 0 ? s / 2 > std::numeric_limits<size_t>::max() / (s + 1)
+                     : (s + 1) / 2 > std::numeric_limits<size_t>::max() / s)
+          throw out_of_range("out_of_range");
+      return s % 2 == 0 ? s / 2 * (s + 1) : (s + 1) / 2 * s;
+  }
+public:
+  typedef T value_type;
+
+  TSymmetricMatrix(size_t s = 1) : n(s), mem(packedSize(s))
+  {
+  }
+
+  // из квадратной матрицы; используется её нижний треугольник
+  explicit TSymmetricMatrix(const TDynamicMatrix<T>& m) : n(m.rows()), mem(packedSize(m.rows()))
+  {
+      if (m.cols() != n)
+          throw length_error("matrix must be square");
+      for (size_t i = 0; i < n; i++)
+          tmatrix_detail::copyElements(m[i].data(), i + 1, row(i));
+  }
+
+  size_t size() const noexcept { return n; }
+  size_t rows() const noexcept { return n; }
+  size_t cols() const noexcept { return n; }
+
+  // начало i-й строки нижнего треугольника (i + 1 элемент)
+  T* row(size_t i) noexcept { return mem.data() + i * (i + 1) / 2; }
+  const T* row(size_t i) const noexcept { return mem.data() + i * (i + 1) / 2; }
+
+  T* data() noexcept { return mem.data(); }
+  const T* data() const noexcept { return mem.data(); }
+
+  T& operator()(size_t i, size_t j) { return i >= j ? row(i)[j] : row(j)[i]; }
+  const T& operator()(size_t i, size_t j) const { return i >= j ? row(i)[j] : row(j)[i]; }
+
+  T& at(size_t i, size_t j)
+  {
+      if (i >= n || j >= n)
+          throw out_of_range("out_of_range");
+      return (*this)(i, j);
+  }
+  const T& at(size_t i, size_t j) const
+  {
+      if (i >= n || j >= n)
+          throw out_of_range("out_of_range");
+      return (*this)(i, j);
+  }
+
+  TDynamicMatrix<T> toMatrix() const
+  {
+      TDynamicMatrix<T> res(n);
+      for (size_t i = 0; i < n; i++)
+      {
+          const T* ri = row(i);
+          for (size_t j = 0; j <= i; j++)
+              res[i][j] = res[j][i] = ri[j];
+      }
+      return res;
+  }
+
+  bool operator==(const TSymmetricMatrix& m) const noexcept
+  {
+      return n == m.n && mem == m.mem;
+  }
+
+  bool operator!=(const TSymmetricMatrix& m) const noexcept
+  {
+      return !(*this == m);
+  }
+
+  TDynamicVector<T> operator*(const TDynamicVector<T>& x) const
+  {
+      TDynamicVector<T> y(n);
+      multiply(*this, x, y);
+      return y;
+  }
+
+  TDynamicMatrix<T> operator*(const TDynamicMatrix<T>& b) const
+  {
+      TDynamicMatrix<T> c(n, b.cols());
+      multiply(*this, b, c);
+      return c;
+  }
+
+  friend ostream& operator<<(ostream& ostr, const TSymmetricMatrix& m)
+  {
+      for (size_t i = 0; i < m.n; i++)
+      {
+          for (size_t j = 0; j < m.n; j++)
+              ostr << m(i, j) << ' ';
+          ostr << endl;
+      }
+      return ostr;
+  }
+};
+
+// SYMV: y = A * x. Первый проход - скалярные произведения строк нижнего
+// треугольника, второй добавляет строго верхний треугольник (L^T x);
+// во втором проходе потоки делят между собой блоки y, поэтому записи не
+// пересекаются, а строки треугольника читаются подряд
+template<typename T>
+void multiply(const TSymmetricMatrix<T>& a, const TDynamicVector<T>& x, TDynamicVector<T>& y)
+{
+  const size_t n = a.size();
+  if (x.size() != n || y.size() != n)
+      throw length_error("length error");
+  if (&x == &y)
+      throw invalid_argument("output vector must not alias an operand");
+  TMATRIX_OPERATION(TOperation::Gemv, n * (n + 1) / 2, 2 * n * n, (n * (n + 1) / 2 + 2 * n) * sizeof(T));
+  const T* px = x.data();
+  T* py = y.data();
+  const size_t grain = std::max<size_t>(1, 16384 / n);
+  tmatrix_detail::parallelFor(0, n, grain, [&](size_t first, size_t last)
+  {
+      for (size_t i = first; i < last; i++)
+          py[i] = tmatrix_detail::dot(a.row(i), px, i + 1);
+  });
+  const size_t block = 256;
+  tmatrix_detail::parallelFor(0, (n + block - 1) / block, 1, [&](size_t first, size_t last)
+  {
+      for (size_t b = first; b < last; b++)
+      {
+          const size_t j0 = b * block, j1 = std::min(n, j0 + block);
+          for (size_t i = j0 + 1; i < n; i++)
+              tmatrix_detail::axpy(px[i], a.row(i) + j0, py + j0, std::min(i, j1) - j0);
+      }
+  });
+}
+
+// SYMM: C = A * B, A симметрична n x n, B - n x p. Строки C считаются
+// независимо: C_i = sum_k A(i, k) B_k
+template<typename T>
+void multiply(const TSymmetricMatrix<T>& a, const TDynamicMatrix<T>& b, TDynamicMatrix<T>& c)
+{
+  const size_t n = a.size(), p = b.cols();
+  if (b.rows() != n || c.rows() != n || c.cols() != p)
+      throw length_error("length error");
+  if (&b == &c)
+      throw invalid_argument("output matrix must not alias an operand");
+  TMATRIX_OPERATION(TOperation::Gemm, n * p, 2 * n * n * p, (n * (n + 1) / 2 + 2 * n * p) * sizeof(T));
+  tmatrix_detail::parallelFor(0, n, 4, [&](size_t first, size_t last)
+  {
+      for (size_t i = first; i < last; i++)
+      {
+          T* ci = c[i].data();
+          std::fill(ci, ci + p, T());
+          const T* ai = a.row(i);
+          for (size_t k = 0; k <= i; k++)
+              tmatrix_detail::axpy(ai[k], b[k].data(), ci, p);
+          for (size_t k = i + 1; k < n; k++)
+              tmatrix_detail::axpy(a.row(k)[i], b[k].data(), ci, p);
+      }
+  });
+}
+
+// SYRK: C = A^T * A для A размера m x n, вычисляется только нижний
+// треугольник: C_i[0..i] += A(k, i) * A_k[0..i] по строкам k матрицы A.
+// Строки A обрабатываются блоками, чтобы блок оставался в кэше для всех
+// строк C, обрабатываемых потоком
+template<typename T>
+void syrk(const TDynamicMatrix<T>& a, TSymmetricMatrix<T>& c)
+{
+  const size_t m = a.rows(), n = a.cols();
+  if (c.size() != n)
+      throw length_error("length error");
+  TMATRIX_OPERATION(TOperation::Gemm, n * (n + 1) / 2, m * n * (n + 1), (m * n + n * (n + 1) / 2) * sizeof(T));
+  const size_t kBlock = 64;
+  tmatrix_detail::parallelFor(0, n, 8, [&](size_t first, size_t last)
+  {
+      for (size_t i = first; i < last; i++)
+          std::fill(c.row(i), c.row(i) + i + 1, T());
+      for (size_t k0 = 0; k0 < m; k0 += kBlock)
+      {
+          const size_t k1 = std::min(m, k0 + kBlock);
+          for (size_t i = first; i < last; i++)
+          {
+              T* ci = c.row(i);
+              for (size_t k = k0; k < k1; k++)
+                  tmatrix_detail::axpy(a[k][i], a[k].data(), ci, i + 1);
+          }
+      }
+  });
+}
+
+template<typename T>
+TSymmetricMatrix<T> syrk(const TDynamicMatrix<T>& a)
+{
+  TSymmetricMatrix<T> c(a.cols());
+  syrk(a, c);
+  return c;
+}
+
+// Ленточная матрица n x n с kl поддиагоналями и ku наддиагоналями.
+// Строки хранятся подряд по width = 2 * kl + ku + 1 элементов: строка i
+// начинается с элемента (i, i - kl); запас в kl элементов справа нужен
+// для заполнения при LU-разложении с перестановками строк
+template<typename T>
+class TBandMatrix
+{
+  size_t n, kl, ku, width;
+  TDynamicVector<T> mem;
+
+  static size_t storageSize(size_t s, size_t lower, size_t upper)
+  {
+      if (s == 0 || lower >= s || upper >= s)
+          throw out_of_range("out_of_range");
+      const size_t w = 2 * lower + upper + 1;
+      if (w > getMaxVectorSize() / s)
+          throw out_of_range("out_of_range");
+      return s * w;
+  }
+public:
+  typedef T value_type;
+
+  TBandMatrix(size_t s, size_t lower, size_t upper)
+      : n(s), kl(lower), ku(upper), width(2 * lower + upper + 1), mem(storageSize(s, lower, upper))
+  {
+  }
+
+  // из плотной матрицы; элементы вне ленты отбрасываются
+  TBandMatrix(const TDynamicMatrix<T>& m, size_t lower, size_t upper)
+      : n(m.rows()), kl(lower), ku(upper), width(2 * lower + upper + 1), mem(storageSize(m.rows(), lower, upper))
+  {
+      if (m.cols() != n)
+          throw length_error("matrix must be square");
+      for (size_t i = 0; i < n; i++)
+          for (size_t j = i > kl ? i - kl : 0; j <= std::min(n - 1, i + ku); j++)
+              (*this)(i, j) = m[i][j];
+  }
+
+  size_t size() const noexcept { return n; }
+  size_t rows() const noexcept { return n; }
+  size_t cols() const noexcept { return n; }
+  size_t lowerBandwidth() const noexcept { return kl; }
+  size_t upperBandwidth() const noexcept { return ku; }
+
+  // элемент (i, j) хранится, если i - kl <= j <= i + ku + kl
+  bool isStored(size_t i, size_t j) const noexcept { return j + kl >= i && j <= i + ku + kl; }
+
+  // начало хранимой части строки i (элемент (i, i - kl))
+  T* row(size_t i) noexcept { return mem.data() + i * width; }
+  const T* row(size_t i) const noexcept { return mem.data() + i * width; }
+
+  T& operator()(size_t i, size_t j) { return row(i)[j + kl - i]; }
+  T operator()(size_t i, size_t j) const { return isStored(i, j) ? row(i)[j + kl - i] : T(); }
+
+  // доступ с контролем: только элементы ленты
+  T& at(size_t i, size_t j)
+  {
+      if (i >= n || j >= n || j + kl < i || j > i + ku)
+          throw out_of_range("out_of_range");
+      return (*this)(i, j);
+  }
+  T at(size_t i, size_t j) const
+  {
+      if (i >= n || j >= n)
+          throw out_of_range("out_of_range");
+      return (*this)(i, j);
+  }
+
+  TDynamicMatrix<T> toMatrix() const
+  {
+      TDynamicMatrix<T> res(n);
+      for (size_t i = 0; i < n; i++)
+          for (size_t j = i > kl ? i - kl : 0; j <= std::min(n - 1, i + ku + kl); j++)
+              res[i][j] = (*this)(i, j);
+      return res;
+  }
+
+  TDynamicVector<T> operator*(const TDynamicVector<T>& x) const
+  {
+      TDynamicVector<T> y(n);
+      multiply(*this, x, y);
+      return y;
+  }
+};
+
+// y = A * x за O(n * (kl + ku))
+template<typename T>
+void multiply(const TBandMatrix<T>& a, const TDynamicVector<T>& x, TDynamicVector<T>& y)
+{
+  const size_t n = a.size(), kl = a.lowerBandwidth(), ku = a.upperBandwidth();
+  if (x.size() != n || y.size() != n)
+      throw length_error("length error");
+  TMATRIX_OPERATION(TOperation::Gemv, n * (kl + ku + 1), 2 * n * (kl + ku + 1), (n * (kl + ku + 3)) * sizeof(T));
+  const T* px = x.data();
+  T* py = y.data();
+  tmatrix_detail::parallelFor(0, n, std::max<size_t>(1, 16384 / (kl + ku + 1)), [&](size_t first, size_t last)
+  {
+      for (size_t i = first; i < last; i++)
+      {
+          const size_t j0 = i > kl ? i - kl : 0, j1 = std::min(n - 1, i + ku);
+          py[i] = tmatrix_detail::dot(a.row(i) + (j0 + kl - i), px + j0, j1 - j0 + 1);
+      }
+  });
+}
+
+// LU-разложение ленточной матрицы с выбором ведущего элемента за
+// O(n * kl * (kl + ku)). Перестановки применяются к строкам справа от
+// текущего столбца, поэтому множители L остаются на месте (как в gbtrf),
+// а U занимает ku + kl наддиагоналей. pivots[k] - строка, переставленная
+// со строкой k на шаге k. Возвращает знак перестановки или 0, если
+// матрица вырождена
+template<typename T>
+int lu(TBandMatrix<T>& a, TDynamicVector<size_t>& pivots)
+{
+  static_assert(std::is_floating_point<T>::value, "lu requires floating point type");
+  const size_t n = a.size(), kl = a.lowerBandwidth(), ku = a.upperBandwidth();
+  pivots = TDynamicVector<size_t>(n);
+  int sign = 1;
+  bool singular = false;
+  for (size_t k = 0; k < n; k++)
+  {
+      const size_t last = std::min(n - 1, k + kl), right = std::min(n - 1, k + kl + ku);
+      size_t p = k;
+      for (size_t i = k + 1; i <= last; i++)
+          if (std::abs(a(i, k)) > std::abs(a(p, k)))
+              p = i;
+      pivots[k] = p;
+      if (p != k)
+      {
+          std::swap_ranges(&a(k, k), &a(k, k) + (right - k + 1), &a(p, k));
+          sign = -sign;
+      }
+      const T pivot = a(k, k);
+      if (pivot == T(0))
+      {
+          singular = true;
+          continue;
+      }
+      for (size_t i = k + 1; i <= last; i++)
+      {
+          T& l = a(i, k);
+          l /= pivot;
+          tmatrix_detail::axpy(-l, &a(k, k) + 1, &a(i, k) + 1, right - k);
+      }
+  }
+  return singular ? 0 : sign;
+}
+
+// Решение A * x = b по ленточному LU-разложению на месте за O(n * (kl + ku))
+template<typename T>
+void luSolveInPlace(const TBandMatrix<T>& lu, const TDynamicVector<size_t>& pivots, TDynamicVector<T>& b)
+{
+  const size_t n = lu.size(), kl = lu.lowerBandwidth(), ku = lu.upperBandwidth();
+  if (b.size() != n || pivots.size() != n)
+      throw length_error("length error");
+  T* x = b.data();
+  for (size_t k = 0; k < n; k++)
+  {
+      std::swap(x[k], x[pivots[k]]);
+      for (size_t i = k + 1; i <= std::min(n - 1, k + kl); i++)
+          x[i] -= lu.row(i)[k + kl - i] * x[k];
+  }
+  for (size_t i = n; i-- > 0;)
+  {
+      const T* ui = lu.row(i) + kl; // элемент (i, i)
+      if (ui[0] == T(0))
+          throw domain_error("matrix is singular");
+      const size_t e = std::min(n - 1, i + kl + ku);
+      x[i] = (x[i] - tmatrix_detail::dot(ui + 1, x + i + 1, e - i)) / ui[0];
+  }
+}
+
+template<typename T>
+TDynamicVector<T> solve(const TBandMatrix<T>& a, const TDynamicVector<T>& b)
+{
+  TBandMatrix<T> f(a);
+  TDynamicVector<size_t> pivots(a.size());
+  if (lu(f, pivots) == 0)
+      throw domain_error("matrix is singular");
+  TDynamicVector<T> x(b);
+  luSolveInPlace(f, pivots, x);
+  return x;
+}
+
+// Трёхдиагональная матрица: поддиагональ lower(i) = A(i, i - 1),
+// диагональ diag(i) = A(i, i) и наддиагональ upper(i) = A(i, i + 1)
+template<typename T>
+class TTridiagonalMatrix
+{
+  TDynamicVector<T> sub, mainDiag, super; // sub[0] и super[n - 1] не используются
+public:
+  typedef T value_type;
+
+  TTridiagonalMatrix(size_t s = 1) : sub(s), mainDiag(s), super(s)
+  {
+  }
+
+  size_t size() const noexcept { return mainDiag.size(); }
+
+  T& lower(size_t i) { return sub[i]; }
+  const T& lower(size_t i) const { return sub[i]; }
+  T& diag(size_t i) { return mainDiag[i]; }
+  const T& diag(size_t i) const { return mainDiag[i]; }
+  T& upper(size_t i) { return super[i]; }
+  const T& upper(size_t i) const { return super[i]; }
+
+  T operator()(size_t i, size_t j) const
+  {
+      if (i == j)
+          return mainDiag[i];
+      if (j + 1 == i)
+          return sub[i];
+      if (i + 1 == j)
+          return super[i];
+      return T();
+  }
+
+  TDynamicMatrix<T> toMatrix() const
+  {
+      const size_t n = size();
+      TDynamicMatrix<T> res(n);
+      for (size_t i = 0; i < n; i++)
+      {
+          res[i][i] = mainDiag[i];
+          if (i > 0)
+              res[i][i - 1] = sub[i];
+          if (i + 1 < n)
+              res[i][i + 1] = super[i];
+      }
+      return res;
+  }
+
+  TDynamicVector<T> operator*(const TDynamicVector<T>& x) const
+  {
+      const size_t n = size();
+      if (x.size() != n)
+          throw length_error("length error");
+      TDynamicVector<T> y(n);
+      for (size_t i = 0; i < n; i++)
+      {
+          T s = mainDiag[i] * x[i];
+          if (i > 0)
+              s += sub[i] * x[i - 1];
+          if (i + 1 < n)
+              s += super[i] * x[i + 1];
+          y[i] = s;
+      }
+      return y;
+  }
+};
+
+// Метод прогонки (Томаса) за O(n) без перестановок: устойчив для матриц с
+// диагональным преобладанием. Правая часть заменяется решением
+template<typename T>
+void thomasSolveInPlace(const TTridiagonalMatrix<T>& a, TDynamicVector<T>& d)
+{
+  const size_t n = a.size();
+  if (d.size() != n)
+      throw length_error("length error");
+  TDynamicVector<T> c(n);
+  T den = a.diag(0);
+  if (den == T(0))
+      throw domain_error("matrix is singular");
+  c[0] = n > 1 ? a.upper(0) / den : T();
+  d[0] /= den;
+  for (size_t i = 1; i < n; i++)
+  {
+      den = a.diag(i) - a.lower(i) * c[i - 1];
+      if (den == T(0))
+          throw domain_error("matrix is singular");
+      c[i] = i + 1 < n ? a.upper(i) / den : T();
+      d[i] = (d[i] - a.lower(i) * d[i - 1]) / den;
+  }
+  for (size_t i = n - 1; i-- > 0;)
+      d[i] -= c[i] * d[i + 1];
+}
+
+template<typename T>
+TDynamicVector<T> solve(const TTridiagonalMatrix<T>& a, const TDynamicVector<T>& b)
+{
+  TDynamicVector<T> x(b);
+  thomasSolveInPlace(a, x);
+  return x;
+}
+
+// Набор count независимых трёхдиагональных систем порядка n. Коэффициенты
+// хранятся матрицами n x count: строка i содержит i-е уравнения всех
+// систем подряд, поэтому прогонка идёт по i, а внутренний цикл по
+// системам векторизуется
+template<typename T>
+class TTridiagonalBatch
+{
+  TDynamicMatrix<T> sub, mainDiag, super;
+public:
+  typedef T value_type;
+
+  TTridiagonalBatch(size_t count, size_t n) : sub(n, count), mainDiag(n, count), super(n, count)
+  {
+  }
+
+  size_t count() const noexcept { return mainDiag.cols(); }
+  size_t dimension() const noexcept { return mainDiag.rows(); }
+
+  // коэффициенты i-го уравнения системы s
+  T& lower(size_t s, size_t i) { return sub[i][s]; }
+  const T& lower(size_t s, size_t i) const { return sub[i][s]; }
+  T& diag(size_t s, size_t i) { return mainDiag[i][s]; }
+  const T& diag(size_t s, size_t i) const { return mainDiag[i][s]; }
+  T& upper(size_t s, size_t i) { return super[i][s]; }
+  const T& upper(size_t s, size_t i) const { return super[i][s]; }
+
+  // строки коэффициентов: i-е уравнения всех систем
+  const T* lowerRow(size_t i) const { return sub[i].data(); }
+  const T* diagRow(size_t i) const { return mainDiag[i].data(); }
+  const T* upperRow(size_t i) const { return super[i].data(); }
+
+  void set(size_t s, const TTridiagonalMatrix<T>& a)
+  {
+      if (s >= count())
+          throw out_of_range("out_of_range");
+      if (a.size() != dimension())
+          throw length_error("length error");
+      for (size_t i = 0; i < dimension(); i++)
+      {
+          sub[i][s] = a.lower(i);
+          mainDiag[i][s] = a.diag(i);
+          super[i][s] = a.upper(i);
+      }
+  }
+};
+
+// Прогонка для всех систем набора: d - матрица n x count, столбец s -
+// правая часть системы s, заменяется решением. Потоки делят системы
+template<typename T>
+void thomasSolveInPlace(const TTridiagonalBatch<T>& a, TDynamicMatrix<T>& d)
+{
+  const size_t n = a.dimension(), m = a.count();
+  if (d.rows() != n || d.cols() != m)
+      throw length_error("length error");
+  TDynamicMatrix<T> c(n, m);
+  std::atomic<bool> singular(false);
+  const size_t grain = std::max<size_t>(64, (m + getNumThreads() - 1) / getNumThreads());
+  tmatrix_detail::parallelFor(0, m, grain, [&](size_t s0, size_t s1)
+  {
+      bool bad = false;
+      {
+          const T* b0 = a.diagRow(0);
+          const T* c0 = a.upperRow(0);
+          T* cp = c[0].data();
+          T* dp = d[0].data();
+          for (size_t s = s0; s < s1; s++)
+          {
+              bad |= b0[s] == T(0);
+              cp[s] = n > 1 ? c0[s] / b0[s] : T();
+              dp[s] /= b0[s];
+          }
+      }
+      for (size_t i = 1; i < n; i++)
+      {
+          const T* ai = a.lowerRow(i);
+          const T* bi = a.diagRow(i);
+          const T* ui = a.upperRow(i);
+          const T* cprev = c[i - 1].data();
+          const T* dprev = d[i - 1].data();
+          T* ci = c[i].data();
+          T* di = d[i].data();
+          const bool hasUpper = i + 1 < n;
+          for (size_t s = s0; s < s1; s++)
+          {
+              const T den = bi[s] - ai[s] * cprev[s];
+              bad |= den == T(0);
+              ci[s] = hasUpper ? ui[s] / den : T();
+              di[s] = (di[s] - ai[s] * dprev[s]) / den;
+          }
+      }
+      for (size_t i = n - 1; i-- > 0;)
+      {
+          const T* ci = c[i].data();
+          const T* dnext = d[i + 1].data();
+          T* di = d[i].data();
+          for (size_t s = s0; s < s1; s++)
+              di[s] -= ci[s] * dnext[s];
+      }
+      if (bad)
+          singular = true;
+  });
+  if (singular)
+      throw domain_error("matrix is singular");
+}
+
 #endif
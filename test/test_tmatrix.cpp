@@ -138,7 +138,7 @@ TEST(TDynamicMatrix, assign_operator_change_matrix_size)
     TDynamicVector<int> v3(arr3, 3);
     TDynamicVector<int> v4(arr4, 3);
     TDynamicVector<int> v5(arr5, 3);
-    TDynamicMatrix<int> matrix2(2);
+    TDynamicMatrix<int> matrix2(3);
     matrix2[0] = v3;
     matrix2[1] = v4;
     matrix2[2] = v5;
@@ -165,7 +165,7 @@ TEST(TDynamicMatrix, can_assign_matrices_of_different_size)
     TDynamicVector<int> v3(arr3, 3);
     TDynamicVector<int> v4(arr4, 3);
     TDynamicVector<int> v5(arr5, 3);
-    TDynamicMatrix<int> matrix2(2);
+    TDynamicMatrix<int> matrix2(3);
     matrix2[0] = v3;
     matrix2[1] = v4;
     matrix2[2] = v5;
@@ -218,7 +218,7 @@ TEST(TDynamicMatrix, matrices_with_different_size_are_not_equal)
     TDynamicVector<int> v3(arr3, 3);
     TDynamicVector<int> v4(arr4, 3);
     TDynamicVector<int> v5(arr5, 3);
-    TDynamicMatrix<int> matrix2(2);
+    TDynamicMatrix<int> matrix2(3);
     matrix2[0] = v3;
     matrix2[1] = v4;
     matrix2[2] = v5;
@@ -340,3 +340,1437 @@ TEST(TDynamicMatrix, cant_subtract_matrixes_with_not_equal_size)
     ASSERT_ANY_THROW(matrix1 - matrix2);
 }
 
+
+static TDynamicMatrix<double> makeSpdMatrix(size_t n)
+{
+    TDynamicMatrix<double> m(n), a(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            m[i][j] = double((i * 7 + j * 13) % 11) - 5.0;
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+        {
+            double s = 0;
+            for (size_t k = 0; k < n; k++)
+                s += m[i][k] * m[j][k];
+            a[i][j] = s + (i == j ? double(n) : 0.0);
+        }
+    return a;
+}
+
+TEST(TDynamicMatrix, cholesky_factor_reproduces_matrix)
+{
+    const size_t n = 150;
+    TDynamicMatrix<double> a = makeSpdMatrix(n);
+    TDynamicMatrix<double> l(a);
+    cholesky(l);
+
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j <= i; j++)
+        {
+            double s = 0;
+            for (size_t k = 0; k <= j; k++)
+                s += l[i][k] * l[j][k];
+            EXPECT_NEAR(a[i][j], s, 1e-8 * a[i][i]);
+        }
+}
+
+TEST(TDynamicMatrix, cholesky_does_not_touch_upper_triangle)
+{
+    TDynamicMatrix<double> a(3);
+    a[0][0] = 4; a[0][1] = -100; a[0][2] = -200;
+    a[1][0] = 2; a[1][1] = 5;    a[1][2] = -300;
+    a[2][0] = 2; a[2][1] = 3;    a[2][2] = 6;
+    cholesky(a);
+
+    EXPECT_DOUBLE_EQ(2.0, a[0][0]);
+    EXPECT_DOUBLE_EQ(1.0, a[1][0]);
+    EXPECT_DOUBLE_EQ(2.0, a[1][1]);
+    EXPECT_DOUBLE_EQ(-100.0, a[0][1]);
+    EXPECT_DOUBLE_EQ(-200.0, a[0][2]);
+    EXPECT_DOUBLE_EQ(-300.0, a[1][2]);
+}
+
+TEST(TDynamicMatrix, cholesky_throws_for_not_positive_definite_matrix)
+{
+    TDynamicMatrix<double> a(2);
+    a[0][0] = 1; a[0][1] = 2;
+    a[1][0] = 2; a[1][1] = 1;
+    ASSERT_ANY_THROW(cholesky(a));
+}
+
+TEST(TDynamicMatrix, cholesky_solve_with_many_right_hand_sides)
+{
+    const size_t n = 100;
+    TDynamicMatrix<double> a = makeSpdMatrix(n);
+    TDynamicMatrix<double> x(n), b(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            x[i][j] = double(i) - double(j) / 3.0;
+    b = a * x;
+
+    TDynamicMatrix<double> l(a);
+    cholesky(l);
+    choleskySolveInPlace(l, b);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            EXPECT_NEAR(x[i][j], b[i][j], 1e-8);
+
+    TDynamicVector<double> v(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            v[i] += a[i][j] * x[j][1];
+    choleskySolveInPlace(l, v);
+    for (size_t i = 0; i < n; i++)
+        EXPECT_NEAR(x[i][1], v[i], 1e-8);
+}
+
+static TDynamicMatrix<double> makeGeneralMatrix(size_t n)
+{
+    TDynamicMatrix<double> a(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            a[i][j] = double((i * 31 + j * 17 + i * j) % 23) - 11.0 + (i == j ? 3.0 * n : 0.0);
+    return a;
+}
+
+TEST(TDynamicMatrix, householder_qr_reproduces_matrix)
+{
+    const size_t n = 130;
+    TDynamicMatrix<double> a = makeGeneralMatrix(n);
+    TDynamicMatrix<double> qr(a);
+    TDynamicVector<double> tau;
+    householderQR(qr, tau);
+
+    TDynamicMatrix<double> r(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = i; j < n; j++)
+            r[i][j] = qr[i][j];
+    applyQ(qr, tau, r);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            EXPECT_NEAR(a[i][j], r[i][j], 1e-9 * n);
+}
+
+TEST(TDynamicMatrix, householder_q_is_orthogonal)
+{
+    const size_t n = 70;
+    TDynamicMatrix<double> qr = makeGeneralMatrix(n);
+    TDynamicVector<double> tau;
+    householderQR(qr, tau);
+
+    TDynamicMatrix<double> e(n);
+    for (size_t i = 0; i < n; i++)
+        e[i][i] = 1;
+    applyQ(qr, tau, e);
+    applyQTransposed(qr, tau, e);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            EXPECT_NEAR(i == j ? 1.0 : 0.0, e[i][j], 1e-12);
+}
+
+TEST(TDynamicMatrix, apply_q_to_vector_matches_matrix_version)
+{
+    const size_t n = 80;
+    TDynamicMatrix<double> qr = makeGeneralMatrix(n);
+    TDynamicVector<double> tau;
+    householderQR(qr, tau);
+
+    TDynamicMatrix<double> b(n);
+    TDynamicVector<double> v(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        b[i][0] = double(i % 7) - 3.0;
+        v[i] = b[i][0];
+    }
+    applyQ(qr, tau, b);
+    applyQ(qr, tau, v);
+    for (size_t i = 0; i < n; i++)
+        EXPECT_NEAR(b[i][0], v[i], 1e-12);
+}
+
+TEST(TDynamicMatrix, qr_solve_finds_solution)
+{
+    const size_t n = 90;
+    TDynamicMatrix<double> a = makeGeneralMatrix(n);
+    TDynamicVector<double> x(n);
+    for (size_t i = 0; i < n; i++)
+        x[i] = double(i) / 10.0 - 2.0;
+    TDynamicVector<double> b = a * x;
+
+    TDynamicVector<double> tau;
+    householderQR(a, tau);
+    TDynamicVector<double> res = qrSolve(a, tau, b);
+    for (size_t i = 0; i < n; i++)
+        EXPECT_NEAR(x[i], res[i], 1e-10);
+}
+
+TEST(TDynamicMatrix, lu_reproduces_permuted_matrix)
+{
+    const size_t n = 100;
+    TDynamicMatrix<double> a = makeGeneralMatrix(n);
+    TDynamicMatrix<double> f(a);
+    TDynamicVector<size_t> pivots;
+    EXPECT_NE(0, lu(f, pivots));
+
+    TDynamicMatrix<double> pa(a);
+    for (size_t j = 0; j < n; j++)
+        swap(pa[j], pa[pivots[j]]);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+        {
+            double s = 0;
+            for (size_t k = 0; k <= std::min(i, j); k++)
+                s += (k == i ? 1.0 : f[i][k]) * f[k][j];
+            EXPECT_NEAR(pa[i][j], s, 1e-9 * n);
+        }
+}
+
+TEST(TDynamicMatrix, can_solve_general_system)
+{
+    const size_t n = 120;
+    TDynamicMatrix<double> a = makeGeneralMatrix(n);
+    TDynamicVector<double> x(n);
+    for (size_t i = 0; i < n; i++)
+        x[i] = double(i % 9) - 4.0;
+    TDynamicVector<double> b = a * x;
+
+    TDynamicVector<double> res = solve(a, b);
+    for (size_t i = 0; i < n; i++)
+        EXPECT_NEAR(x[i], res[i], 1e-10);
+}
+
+TEST(TDynamicMatrix, can_solve_system_with_many_right_hand_sides)
+{
+    const size_t n = 90;
+    TDynamicMatrix<double> a = makeGeneralMatrix(n), spd = makeSpdMatrix(n);
+    TDynamicMatrix<double> x(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            x[i][j] = double((i + 2 * j) % 5) - 2.0;
+
+    TDynamicMatrix<double> res = solve(a, a * x);
+    TDynamicMatrix<double> resSpd = solve(spd, spd * x, TMatrixStructure::SymmetricPositiveDefinite);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+        {
+            EXPECT_NEAR(x[i][j], res[i][j], 1e-10);
+            EXPECT_NEAR(x[i][j], resSpd[i][j], 1e-8);
+        }
+}
+
+TEST(TDynamicMatrix, can_solve_triangular_systems)
+{
+    TDynamicMatrix<double> l(3), u(3);
+    l[0][0] = 2;
+    l[1][0] = 1; l[1][1] = 4;
+    l[2][0] = 3; l[2][1] = 2; l[2][2] = 1;
+    u[0][0] = 1; u[0][1] = 2; u[0][2] = 3;
+    u[1][1] = 4; u[1][2] = 5;
+    u[2][2] = 6;
+    double arr[3]{ 2, 9, 10 };
+    TDynamicVector<double> b(arr, 3);
+
+    TDynamicVector<double> y = solve(l, b, TMatrixStructure::LowerTriangular);
+    EXPECT_DOUBLE_EQ(1.0, y[0]);
+    EXPECT_DOUBLE_EQ(2.0, y[1]);
+    EXPECT_DOUBLE_EQ(3.0, y[2]);
+
+    TDynamicVector<double> z = solve(u, l * y, TMatrixStructure::UpperTriangular);
+    TDynamicVector<double> check = u * z;
+    for (size_t i = 0; i < 3; i++)
+        EXPECT_NEAR(b[i], check[i], 1e-12);
+}
+
+TEST(TDynamicMatrix, solver_reuses_factorization)
+{
+    const size_t n = 40;
+    TDynamicMatrix<double> a = makeGeneralMatrix(n);
+    TLinearSolver<double> solver(a);
+    for (int r = 0; r < 3; r++)
+    {
+        TDynamicVector<double> x(n);
+        for (size_t i = 0; i < n; i++)
+            x[i] = double(r) + double(i);
+        TDynamicVector<double> res = solver.solve(a * x);
+        for (size_t i = 0; i < n; i++)
+            EXPECT_NEAR(x[i], res[i], 1e-10);
+    }
+}
+
+TEST(TDynamicMatrix, throws_when_solve_singular_system)
+{
+    TDynamicMatrix<double> a(2);
+    a[0][0] = 1; a[0][1] = 2;
+    a[1][0] = 2; a[1][1] = 4;
+    TDynamicVector<double> b(2);
+    ASSERT_ANY_THROW(solve(a, b));
+}
+
+TEST(TDynamicMatrix, can_multiply_matrices_larger_than_block)
+{
+    const size_t n = 150;
+    TDynamicMatrix<int> a(n), b(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+        {
+            a[i][j] = int((i + j) % 7) - 3;
+            b[i][j] = int((i * j) % 5) - 2;
+        }
+    TDynamicMatrix<int> c = a * b;
+    for (size_t i = 0; i < n; i += 13)
+        for (size_t j = 0; j < n; j += 11)
+        {
+            int s = 0;
+            for (size_t k = 0; k < n; k++)
+                s += a[i][k] * b[k][j];
+            EXPECT_EQ(s, c[i][j]);
+        }
+}
+
+TEST(TDynamicMatrix, power_equals_repeated_multiplication)
+{
+    const size_t n = 5;
+    TDynamicMatrix<long long> a(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            a[i][j] = (i + 2 * j) % 3;
+    TDynamicMatrix<long long> expected(a);
+    for (uint64_t p = 1; p <= 12; p++)
+    {
+        EXPECT_EQ(expected, pow(a, p));
+        expected = expected * a;
+    }
+}
+
+TEST(TDynamicMatrix, power_zero_is_identity)
+{
+    TDynamicMatrix<int> a(3), e(3);
+    for (size_t i = 0; i < 3; i++)
+    {
+        e[i][i] = 1;
+        a[i][0] = 5;
+    }
+    EXPECT_EQ(e, pow(a, 0));
+}
+
+struct TModular
+{
+    static const long long mod = 1000000007;
+    long long value;
+    TModular(long long v = 0) : value(v % mod) {}
+    TModular& operator+=(const TModular& m) { value = (value + m.value) % mod; return *this; }
+    TModular operator*(const TModular& m) const { return TModular(value * m.value); }
+    bool operator!=(const TModular& m) const { return value != m.value; }
+};
+
+TEST(TDynamicMatrix, power_supports_modular_arithmetic)
+{
+    TDynamicMatrix<TModular> fib(2);
+    fib[0][0] = 1; fib[0][1] = 1;
+    fib[1][0] = 1;
+    TDynamicMatrix<TModular> res = pow(fib, 1000000000ULL);
+    EXPECT_EQ(21, res[0][1].value);
+    EXPECT_EQ(999999994, res[0][0].value);
+}
+
+TEST(TDynamicMatrix, can_compute_determinant_of_double_matrix)
+{
+    TDynamicMatrix<double> a(3);
+    a[0][0] = 2; a[0][1] = -3; a[0][2] = 1;
+    a[1][0] = 2; a[1][1] = 0;  a[1][2] = -1;
+    a[2][0] = 1; a[2][1] = 4;  a[2][2] = 5;
+    EXPECT_NEAR(49.0, det(a), 1e-12);
+}
+
+TEST(TDynamicMatrix, determinant_of_large_triangular_matrix_is_product_of_diagonal)
+{
+    const size_t n = 100;
+    TDynamicMatrix<double> a(n);
+    double expected = 1;
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t j = 0; j < i; j++)
+            a[j][i] = double(i + j);
+        a[i][i] = (i % 2 == 0) ? 1.25 : -0.8;
+        expected *= a[i][i];
+    }
+    EXPECT_NEAR(expected, det(a), 1e-10);
+}
+
+TEST(TDynamicMatrix, determinant_of_singular_matrix_is_zero)
+{
+    TDynamicMatrix<double> a(3);
+    TDynamicMatrix<int> b(3);
+    for (size_t i = 0; i < 3; i++)
+        for (size_t j = 0; j < 3; j++)
+        {
+            a[i][j] = double(i + j);
+            b[i][j] = int(i + j);
+        }
+    EXPECT_EQ(0.0, det(a));
+    EXPECT_EQ(0, det(b));
+}
+
+TEST(TDynamicMatrix, integer_determinant_is_exact)
+{
+    TDynamicMatrix<int> a(3);
+    a[0][0] = 0; a[0][1] = 2; a[0][2] = 1;
+    a[1][0] = 3; a[1][1] = 1; a[1][2] = 4;
+    a[2][0] = 5; a[2][1] = 9; a[2][2] = 2;
+    EXPECT_EQ(50, det(a));
+
+    // матрица Вандермонда: определитель - произведение разностей узлов
+    const size_t n = 9;
+    TDynamicMatrix<long long> v(n);
+    long long expected = 1;
+    for (size_t i = 0; i < n; i++)
+    {
+        long long p = 1;
+        for (size_t j = 0; j < n; j++, p *= (long long)(i + 1))
+            v[i][j] = p;
+        for (size_t j = 0; j < i; j++)
+            expected *= (long long)(i - j);
+    }
+    EXPECT_EQ(expected, det(v));
+}
+
+TEST(TDynamicMatrix, can_invert_small_matrix)
+{
+    TDynamicMatrix<double> a(2);
+    a[0][0] = 4; a[0][1] = 7;
+    a[1][0] = 2; a[1][1] = 6;
+    TDynamicMatrix<double> inv = a.inverse();
+    EXPECT_NEAR(0.6, inv[0][0], 1e-12);
+    EXPECT_NEAR(-0.7, inv[0][1], 1e-12);
+    EXPECT_NEAR(-0.2, inv[1][0], 1e-12);
+    EXPECT_NEAR(0.4, inv[1][1], 1e-12);
+    EXPECT_DOUBLE_EQ(4.0, a[0][0]);
+}
+
+TEST(TDynamicMatrix, inverse_times_matrix_is_identity)
+{
+    const size_t n = 150;
+    TDynamicMatrix<double> a = makeGeneralMatrix(n);
+    TDynamicMatrix<double> invLU(a), invGJ(a);
+    invLU.invertInPlace();
+    invGJ.invertInPlace(TInversionMethod::GaussJordan);
+
+    TDynamicMatrix<double> e1 = invLU * a, e2 = invGJ * a;
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+        {
+            EXPECT_NEAR(i == j ? 1.0 : 0.0, e1[i][j], 1e-10);
+            EXPECT_NEAR(i == j ? 1.0 : 0.0, e2[i][j], 1e-10);
+        }
+}
+
+TEST(TDynamicMatrix, inversion_with_pivoting)
+{
+    TDynamicMatrix<double> a(3);
+    a[0][1] = 1;
+    a[1][2] = 2;
+    a[2][0] = 4;
+    for (TInversionMethod method : { TInversionMethod::LU, TInversionMethod::GaussJordan })
+    {
+        TDynamicMatrix<double> inv = a.inverse(method);
+        EXPECT_DOUBLE_EQ(0.25, inv[0][2]);
+        EXPECT_DOUBLE_EQ(1.0, inv[1][0]);
+        EXPECT_DOUBLE_EQ(0.5, inv[2][1]);
+        EXPECT_DOUBLE_EQ(0.0, inv[0][0]);
+    }
+}
+
+TEST(TDynamicMatrix, throws_when_invert_singular_matrix)
+{
+    TDynamicMatrix<double> a(3);
+    for (size_t i = 0; i < 3; i++)
+        for (size_t j = 0; j < 3; j++)
+            a[i][j] = double(i + j);
+    ASSERT_ANY_THROW(a.inverse());
+    ASSERT_ANY_THROW(a.inverse(TInversionMethod::GaussJordan));
+}
+
+TEST(TDynamicMatrix, power_iteration_finds_dominant_eigenpair)
+{
+    TDynamicMatrix<double> a(3);
+    a[0][0] = 2; a[0][1] = 1;
+    a[1][0] = 1; a[1][1] = 3; a[1][2] = 1;
+    a[2][1] = 1; a[2][2] = 4;
+    TDynamicVector<double> x(3);
+    x[0] = 1;
+
+    double lambda = powerIteration(a, x);
+    TDynamicVector<double> ax = a * x;
+    for (size_t i = 0; i < 3; i++)
+        EXPECT_NEAR(lambda * x[i], ax[i], 1e-8);
+    EXPECT_NEAR(3.0 + std::sqrt(3.0), lambda, 1e-8);
+}
+
+TEST(TDynamicMatrix, jacobi_finds_full_spectrum_of_symmetric_matrix)
+{
+    const size_t n = 41;
+    TDynamicMatrix<double> a(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j <= i; j++)
+            a[i][j] = a[j][i] = double((i * 5 + j * 3) % 7) - 3.0 + (i == j ? double(i) : 0.0);
+
+    TEigenPairs<double> eig = jacobiEigen(a);
+    double trace = 0, sum = 0;
+    for (size_t k = 0; k < n; k++)
+    {
+        trace += a[k][k];
+        sum += eig.values[k];
+        if (k > 0)
+        {
+            EXPECT_GE(eig.values[k - 1], eig.values[k]);
+        }
+        TDynamicVector<double> av = a * eig.vectors[k];
+        for (size_t i = 0; i < n; i++)
+            EXPECT_NEAR(eig.values[k] * eig.vectors[k][i], av[i], 1e-8);
+    }
+    EXPECT_NEAR(trace, sum, 1e-8);
+}
+
+TEST(TDynamicMatrix, lanczos_finds_top_eigenpairs_of_operator)
+{
+    const size_t n = 300;
+    auto op = [n](const TDynamicVector<double>& x, TDynamicVector<double>& y)
+    {
+        for (size_t i = 0; i < n; i++)
+            y[i] = double(i + 1) * x[i];
+    };
+    TDynamicVector<double> start(n);
+    for (size_t i = 0; i < n; i++)
+        start[i] = 1.0 + double(i % 3);
+
+    TEigenPairs<double> eig = lanczos(op, start, 3, 120);
+    ASSERT_EQ(size_t(3), eig.values.size());
+    for (size_t k = 0; k < 3; k++)
+    {
+        EXPECT_NEAR(double(n - k), eig.values[k], 1e-6);
+        EXPECT_NEAR(1.0, std::abs(eig.vectors[k][n - 1 - k]), 1e-6);
+    }
+}
+
+TEST(TDynamicMatrix, jacobi_svd_reconstructs_matrix)
+{
+    const size_t n = 30;
+    TDynamicMatrix<double> a = makeGeneralMatrix(n);
+    TSingularTriplets<double> svd = jacobiSvd(a);
+
+    ASSERT_EQ(n, svd.values.size());
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+        {
+            double s = 0;
+            for (size_t k = 0; k < n; k++)
+                s += svd.values[k] * svd.left[k][i] * svd.right[k][j];
+            EXPECT_NEAR(a[i][j], s, 1e-9);
+        }
+    for (size_t k = 1; k < n; k++)
+    {
+        EXPECT_GE(svd.values[k - 1], svd.values[k]);
+        EXPECT_NEAR(0.0, svd.left[k] * svd.left[k - 1], 1e-10);
+        EXPECT_NEAR(0.0, svd.right[k] * svd.right[k - 1], 1e-10);
+    }
+}
+
+TEST(TDynamicMatrix, jacobi_svd_of_diagonal_matrix)
+{
+    TDynamicMatrix<double> a(3);
+    a[0][0] = 1;
+    a[1][1] = -5;
+    a[2][2] = 3;
+    TSingularTriplets<double> svd = jacobiSvd(a);
+    EXPECT_NEAR(5.0, svd.values[0], 1e-12);
+    EXPECT_NEAR(3.0, svd.values[1], 1e-12);
+    EXPECT_NEAR(1.0, svd.values[2], 1e-12);
+}
+
+TEST(TDynamicMatrix, randomized_svd_finds_top_singular_triplets)
+{
+    const size_t n = 200, rank = 5;
+    TDynamicMatrix<double> x = makeGeneralMatrix(n), y = makeSpdMatrix(n);
+    TDynamicVector<double> tx, ty;
+    householderQR(x, tx);
+    householderQR(y, ty);
+    TDynamicMatrix<double> qx(n), qy(n);
+    for (size_t i = 0; i < n; i++)
+        qx[i][i] = qy[i][i] = 1;
+    applyQ(x, tx, qx);
+    applyQ(y, ty, qy);
+
+    double sigma[rank]{ 50, 20, 10, 5, 1 };
+    TDynamicMatrix<double> a(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            for (size_t r = 0; r < rank; r++)
+                a[i][j] += sigma[r] * qx[i][r] * qy[j][r];
+
+    TSingularTriplets<double> svd = randomizedSvd(a, 3);
+    ASSERT_EQ(size_t(3), svd.values.size());
+    for (size_t r = 0; r < 3; r++)
+    {
+        EXPECT_NEAR(sigma[r], svd.values[r], 1e-8);
+        double ux = 0, vy = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            ux += svd.left[r][i] * qx[i][r];
+            vy += svd.right[r][i] * qy[i][r];
+        }
+        EXPECT_NEAR(1.0, std::abs(ux), 1e-8);
+        EXPECT_NEAR(1.0, std::abs(vy), 1e-8);
+    }
+}
+
+TEST(TDynamicMatrix, can_store_matrices_in_batch)
+{
+    TMatrixBatch<double> batch(11, 3);
+    TDynamicMatrix<double> m(3);
+    for (size_t i = 0; i < 3; i++)
+        for (size_t j = 0; j < 3; j++)
+            m[i][j] = double(i * 3 + j);
+    batch.set(9, m);
+
+    EXPECT_EQ(11, batch.size());
+    EXPECT_EQ(m, batch.get(9));
+    EXPECT_EQ(5.0, batch(9, 1, 2));
+    EXPECT_EQ(0.0, batch(8, 1, 2));
+    ASSERT_ANY_THROW(batch.get(11));
+    ASSERT_ANY_THROW(batch.set(0, TDynamicMatrix<double>(3, 2)));
+}
+
+TEST(TDynamicMatrix, batched_multiplication_matches_operator)
+{
+    const size_t lanes = TMatrixBatch<double>::lanes;
+    // полные группы, неполная последняя группа и одна неполная группа
+    for (size_t count : { 2 * lanes, 2 * lanes + 5, lanes - 3 })
+        for (size_t n : { 3, 4, 8, 16, 32, 64 })
+        {
+            TMatrixBatch<double> a(count, n), b(count, n), c(count, n);
+            for (size_t k = 0; k < count; k++)
+                for (size_t i = 0; i < n; i++)
+                    for (size_t j = 0; j < n; j++)
+                    {
+                        a(k, i, j) = double((k + i * 3 + j) % 7) - 3.0;
+                        b(k, i, j) = double((k * 2 + i + j * 5) % 5) - 2.0;
+                    }
+            multiplyBatched(a, b, c);
+            for (size_t k = 0; k < count; k++)
+            {
+                EXPECT_EQ(a.get(k) * b.get(k), c.get(k));
+                for (size_t i = 0; i < n; i++)
+                    for (size_t j = 0; j < n; j++)
+                    {
+                        double sum = 0;
+                        for (size_t l = 0; l < n; l++)
+                            sum += a(k, i, l) * b(k, l, j);
+                        EXPECT_EQ(sum, c(k, i, j));
+                    }
+            }
+        }
+}
+
+TEST(TDynamicMatrix, cant_multiply_batches_with_different_sizes)
+{
+    TMatrixBatch<float> a(4, 8), b(4, 8), c(5, 8);
+    ASSERT_ANY_THROW(multiplyBatched(a, b, c));
+}
+
+TEST(TDynamicMatrix, cant_multiply_batch_in_place)
+{
+    TMatrixBatch<double> a(4, 8), b(4, 8);
+    ASSERT_THROW(multiplyBatched(a, b, a), std::invalid_argument);
+    ASSERT_THROW(multiplyBatched(a, b, b), std::invalid_argument);
+}
+
+TEST(TDynamicMatrix, can_create_rectangular_matrix)
+{
+    TDynamicMatrix<int> m(3, 5);
+    EXPECT_EQ(3, m.rows());
+    EXPECT_EQ(5, m.cols());
+    EXPECT_EQ(5, m[2].size());
+    ASSERT_NO_THROW(TDynamicMatrix<float> tall(100000, 8));
+    ASSERT_ANY_THROW(TDynamicMatrix<int> wide(5, 0));
+    ASSERT_ANY_THROW(TDynamicMatrix<int> huge(MAX_MATRIX_SIZE + 1, MAX_MATRIX_SIZE));
+}
+
+TEST(TDynamicMatrix, matrices_with_different_shape_are_not_equal)
+{
+    TDynamicMatrix<int> a(2, 3), b(3, 2);
+    EXPECT_NE(a, b);
+    ASSERT_ANY_THROW(a + b);
+}
+
+TEST(TDynamicMatrix, can_multiply_rectangular_matrices)
+{
+    TDynamicMatrix<int> a(2, 3), b(3, 4);
+    for (size_t i = 0; i < 2; i++)
+        for (size_t j = 0; j < 3; j++)
+            a[i][j] = int(i + j);
+    for (size_t i = 0; i < 3; i++)
+        for (size_t j = 0; j < 4; j++)
+            b[i][j] = int(i * j) - 1;
+
+    TDynamicMatrix<int> c = a * b;
+    ASSERT_EQ(2, c.rows());
+    ASSERT_EQ(4, c.cols());
+    for (size_t i = 0; i < 2; i++)
+        for (size_t j = 0; j < 4; j++)
+        {
+            int s = 0;
+            for (size_t k = 0; k < 3; k++)
+                s += a[i][k] * b[k][j];
+            EXPECT_EQ(s, c[i][j]);
+        }
+    ASSERT_ANY_THROW(b * a);
+}
+
+TEST(TDynamicMatrix, can_multiply_rectangular_matrix_by_vector)
+{
+    TDynamicMatrix<int> a(3, 2);
+    a[0][0] = 1; a[0][1] = 2;
+    a[1][0] = 3; a[1][1] = 4;
+    a[2][0] = 5; a[2][1] = 6;
+    int arr[2]{ 1, -1 };
+    TDynamicVector<int> v(arr, 2), res = a * v;
+    ASSERT_EQ(3, res.size());
+    EXPECT_EQ(-1, res[0]);
+    EXPECT_EQ(-1, res[2]);
+
+    int arr2[3]{ 1, 0, 2 };
+    TDynamicVector<int> w(arr2, 3), y(2);
+    multiplyTransposed(a, w, y);
+    EXPECT_EQ(11, y[0]);
+    EXPECT_EQ(14, y[1]);
+    ASSERT_ANY_THROW(a * w);
+}
+
+TEST(TDynamicMatrix, can_transpose_matrix)
+{
+    TDynamicMatrix<int> a(70, 45);
+    for (size_t i = 0; i < 70; i++)
+        for (size_t j = 0; j < 45; j++)
+            a[i][j] = int(i * 100 + j);
+    TDynamicMatrix<int> t = a.transpose();
+    ASSERT_EQ(45, t.rows());
+    ASSERT_EQ(70, t.cols());
+    for (size_t i = 0; i < 70; i++)
+        for (size_t j = 0; j < 45; j++)
+            EXPECT_EQ(a[i][j], t[j][i]);
+    EXPECT_EQ(a, t.transpose());
+}
+
+TEST(TDynamicMatrix, qr_solves_tall_least_squares_problem)
+{
+    const size_t m = 500, n = 3;
+    TDynamicMatrix<double> a(m, n);
+    TDynamicVector<double> b(m);
+    for (size_t i = 0; i < m; i++)
+    {
+        const double t = double(i) / m;
+        a[i][0] = 1;
+        a[i][1] = t;
+        a[i][2] = t * t;
+        b[i] = 2.0 - 3.0 * t + 0.5 * t * t + ((i % 2) ? 1e-3 : -1e-3);
+    }
+    TDynamicVector<double> tau;
+    householderQR(a, tau);
+    EXPECT_EQ(n, tau.size());
+    TDynamicVector<double> x = qrSolve(a, tau, b);
+    EXPECT_NEAR(2.0, x[0], 1e-3);
+    EXPECT_NEAR(-3.0, x[1], 1e-2);
+    EXPECT_NEAR(0.5, x[2], 1e-2);
+}
+
+TEST(TDynamicMatrix, square_only_operations_reject_rectangular_matrix)
+{
+    TDynamicMatrix<double> a(3, 2);
+    TDynamicVector<size_t> pivots;
+    ASSERT_ANY_THROW(cholesky(a));
+    ASSERT_ANY_THROW(lu(a, pivots));
+    ASSERT_ANY_THROW(det(a));
+    ASSERT_ANY_THROW(a.inverse());
+}
+
+TEST(TDynamicMatrix, jacobi_svd_of_tall_matrix)
+{
+    TDynamicMatrix<double> a(6, 2);
+    for (size_t i = 0; i < 6; i++)
+    {
+        a[i][0] = double(i);
+        a[i][1] = double(i % 3) - 1.0;
+    }
+    TSingularTriplets<double> svd = jacobiSvd(a);
+    ASSERT_EQ(2, svd.values.size());
+    ASSERT_EQ(6, svd.left[0].size());
+    ASSERT_EQ(2, svd.right[0].size());
+    for (size_t i = 0; i < 6; i++)
+        for (size_t j = 0; j < 2; j++)
+            EXPECT_NEAR(a[i][j], svd.values[0] * svd.left[0][i] * svd.right[0][j]
+                + svd.values[1] * svd.left[1][i] * svd.right[1][j], 1e-12);
+}
+
+static TDynamicMatrix<int> makeNumberedMatrix(size_t rows, size_t cols)
+{
+    TDynamicMatrix<int> m(rows, cols);
+    for (size_t i = 0; i < rows; i++)
+        for (size_t j = 0; j < cols; j++)
+            m[i][j] = int(i * 10 + j);
+    return m;
+}
+
+TEST(TDynamicMatrix, block_view_reads_and_writes_matrix_without_copy)
+{
+    TDynamicMatrix<int> m = makeNumberedMatrix(4, 5);
+    TMatrixBlockView<int> b = m.block(1, 2, 2, 3);
+    EXPECT_EQ(2, b.rows());
+    EXPECT_EQ(3, b.cols());
+    EXPECT_EQ(12, b(0, 0));
+    EXPECT_EQ(24, b(1, 2));
+
+    b(1, 1) = -1;
+    EXPECT_EQ(-1, m[2][3]);
+    b *= 2;
+    EXPECT_EQ(24, m[1][2]);
+    EXPECT_EQ(0, m[0][0]);
+    EXPECT_EQ(10, m[1][0]);
+    ASSERT_ANY_THROW(m.block(3, 0, 2, 1));
+}
+
+TEST(TDynamicMatrix, can_assign_matrix_to_block)
+{
+    TDynamicMatrix<int> m(4), src = makeNumberedMatrix(2, 2);
+    m.block(2, 1, 2, 2) = src;
+    EXPECT_EQ(0, m[2][1]);
+    EXPECT_EQ(11, m[3][2]);
+    EXPECT_EQ(src, m.block(2, 1, 2, 2).toMatrix());
+    m.block(0, 0, 2, 2) = m.block(2, 1, 2, 2);
+    EXPECT_EQ(src, m.block(0, 0, 2, 2));
+    ASSERT_ANY_THROW(m.block(0, 0, 3, 3) = src);
+}
+
+TEST(TDynamicMatrix, block_arithmetic_matches_matrix_arithmetic)
+{
+    TDynamicMatrix<int> m = makeNumberedMatrix(6, 6);
+    TDynamicMatrix<int> a = m.block(0, 0, 3, 4).toMatrix(), b = m.block(2, 1, 4, 3).toMatrix();
+    EXPECT_EQ(a * b, m.block(0, 0, 3, 4) * m.block(2, 1, 4, 3));
+    EXPECT_EQ(a + a, m.block(0, 0, 3, 4) + a);
+    EXPECT_EQ(a - a, a - m.block(0, 0, 3, 4));
+
+    int arr[4]{ 1, 2, 3, 4 };
+    TDynamicVector<int> v(arr, 4);
+    EXPECT_EQ(a * v, m.block(0, 0, 3, 4) * v);
+}
+
+TEST(TDynamicMatrix, row_and_column_views_support_arithmetic)
+{
+    TDynamicMatrix<int> m = makeNumberedMatrix(3, 3);
+    TMatrixRowView<int> r = m.row(1);
+    TMatrixColumnView<int> c = m.col(2);
+    EXPECT_EQ(3, c.size());
+    EXPECT_EQ(22, c[2]);
+
+    EXPECT_EQ(10 * 2 + 11 * 12 + 12 * 22, r * c);
+    TDynamicVector<int> sum = r + c;
+    EXPECT_EQ(12, sum[0]);
+    EXPECT_EQ(m[1] * 2, r * 2);
+
+    c += r;
+    EXPECT_EQ(12, m[0][2]);
+    EXPECT_EQ(23, m[1][2]);
+    c = m[0];
+    EXPECT_EQ(1, m[1][2]);
+    r = 7;
+    EXPECT_EQ(7, m[1][0]);
+    EXPECT_TRUE(m.row(1) == m.row(1).toVector());
+    ASSERT_ANY_THROW(r.at(3));
+}
+
+TEST(TDynamicMatrix, const_matrix_gives_read_only_views)
+{
+    const TDynamicMatrix<int> m = makeNumberedMatrix(3, 4);
+    TMatrixBlockView<const int> b = m.block(1, 1, 2, 2);
+    TMatrixColumnView<const int> c = m.col(3);
+    EXPECT_EQ(22, b(1, 1));
+    EXPECT_EQ(23, c[2]);
+    EXPECT_EQ(m.row(2).toVector(), m[2]);
+}
+
+TEST(TDynamicMatrix, cow_matrix_detaches_on_first_write)
+{
+    TCowMatrix<int> m(makeNumberedMatrix(3, 4));
+    TCowMatrix<int> c = m;
+    EXPECT_EQ(2, m.useCount());
+    EXPECT_EQ(3, c.rows());
+    EXPECT_EQ(4, c.cols());
+
+    c[1][2] = -1;
+    EXPECT_FALSE(m.isShared());
+    EXPECT_EQ(12, m[1][2]);
+    EXPECT_EQ(-1, c[1][2]);
+    EXPECT_NE(m, c);
+
+    ASSERT_ANY_THROW(c[0] = TDynamicVector<int>(7));
+    EXPECT_EQ(4, c.matrix()[0].size());
+
+    // после записи c больше не разделяет память: перемещение копирует данные
+    TCowMatrix<int> moved(std::move(c));
+    EXPECT_EQ(3, c.rows());
+    EXPECT_EQ(1, c.useCount());
+    EXPECT_EQ(-1, moved.matrix()[1][2]);
+    EXPECT_NE(&c.matrix(), &moved.matrix());
+}
+
+TEST(TDynamicMatrix, half_and_bfloat16_round_to_nearest_even)
+{
+    EXPECT_EQ(0x3c00, THalf(1.0f).raw());
+    EXPECT_EQ(-2.5f, float(THalf(-2.5f)));
+    EXPECT_EQ(65504.0f, float(THalf(65504.0f)));
+    EXPECT_EQ(0.0999755859375f, float(THalf(0.1f)));
+    EXPECT_EQ(std::ldexp(1.0f, -24), float(THalf(std::ldexp(1.0f, -24))));
+    EXPECT_EQ(0x7c00, THalf(1e6f).raw());
+    EXPECT_TRUE(std::isnan(float(THalf(std::numeric_limits<float>::quiet_NaN()))));
+    // 2049 лежит посередине между 2048 и 2050: округление к чётному
+    EXPECT_EQ(2048.0f, float(THalf(2049.0f)));
+
+    EXPECT_EQ(0x3f80, TBFloat16(1.0f).raw());
+    EXPECT_EQ(256.0f, float(TBFloat16(257.0f)));
+    EXPECT_TRUE(std::isnan(float(TBFloat16(std::numeric_limits<float>::quiet_NaN()))));
+}
+
+TEST(TDynamicMatrix, half_dot_product_accumulates_in_float)
+{
+    TDynamicVector<THalf> x(4096), y(4096);
+    for (size_t i = 0; i < x.size(); i++)
+    {
+        x[i] = 1.0f;
+        y[i] = 1.0f;
+    }
+    EXPECT_EQ(4096.0f, float(x * y));
+}
+
+TEST(TDynamicMatrix, mixed_precision_gemv_matches_float_reference)
+{
+    const size_t m = 37, n = 300;
+    TDynamicMatrix<THalf> a(m, n);
+    TDynamicMatrix<float> af(m, n);
+    TDynamicVector<THalf> x(n);
+    TDynamicVector<float> xf(n), y(m), yh(1);
+    for (size_t j = 0; j < n; j++)
+    {
+        x[j] = float(j % 5) * 0.25f;
+        xf[j] = x[j];
+    }
+    for (size_t i = 0; i < m; i++)
+        for (size_t j = 0; j < n; j++)
+        {
+            a[i][j] = float((i + j) % 9) - 4.0f;
+            af[i][j] = a[i][j];
+        }
+
+    multiply(a, x, y);
+    TDynamicVector<float> ref = af * xf;
+    for (size_t i = 0; i < m; i++)
+        EXPECT_FLOAT_EQ(ref[i], y[i]);
+    ASSERT_ANY_THROW(multiply(a, x, yh));
+}
+
+TEST(TDynamicMatrix, mixed_precision_gemm_matches_float_reference)
+{
+    const size_t m = 20, k = 150, n = 33;
+    TDynamicMatrix<TBFloat16> a(m, k), b(k, n);
+    TDynamicMatrix<float> af(m, k), bf(k, n), c(m, n);
+    for (size_t i = 0; i < m; i++)
+        for (size_t j = 0; j < k; j++)
+            af[i][j] = a[i][j] = float(int(i * 3 + j) % 7) - 3.0f;
+    for (size_t i = 0; i < k; i++)
+        for (size_t j = 0; j < n; j++)
+            bf[i][j] = b[i][j] = float(int(i + 2 * j) % 5) * 0.5f;
+
+    multiply(a, b, c);
+    EXPECT_EQ(af * bf, c);
+
+    TDynamicMatrix<TBFloat16> ch(m, n);
+    multiply(a, b, ch);
+    EXPECT_EQ(TBFloat16(c[3][4]).raw(), ch[3][4].raw());
+}
+
+TEST(TDynamicMatrix, quantize_dequantize_is_within_half_step)
+{
+    TDynamicMatrix<float> m(3, 50);
+    for (size_t i = 0; i < m.rows(); i++)
+        for (size_t j = 0; j < m.cols(); j++)
+            m[i][j] = float(i + 1) * (float(j) / 7.0f - 3.0f);
+    m[2][10] = 0.0f;
+
+    TQuantizedMatrix q = quantize(m);
+    TDynamicMatrix<float> d = dequantize(q);
+    for (size_t i = 0; i < m.rows(); i++)
+        for (size_t j = 0; j < m.cols(); j++)
+            EXPECT_NEAR(m[i][j], d[i][j], 0.5f * q.scale(i) + 1e-6f);
+    EXPECT_EQ(0.0f, d[2][10]);
+}
+
+TEST(TDynamicMatrix, quantized_gemm_matches_dequantized_product)
+{
+    const size_t m = 9, k = 70, n = 6;
+    TDynamicMatrix<float> a(m, k), b(n, k);
+    for (size_t i = 0; i < m; i++)
+        for (size_t j = 0; j < k; j++)
+            a[i][j] = std::sin(float(i * k + j));
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < k; j++)
+            b[i][j] = std::cos(float(i + 3 * j));
+
+    TQuantizedMatrix qa(a), qb(b);
+    TDynamicMatrix<float> c(m, n);
+    multiplyByTransposed(qa, qb, c);
+
+    TDynamicMatrix<float> da = qa.dequantize(), db = qb.dequantize();
+    for (size_t i = 0; i < m; i++)
+        for (size_t j = 0; j < n; j++)
+        {
+            float ref = 0.0f;
+            for (size_t t = 0; t < k; t++)
+                ref += da[i][t] * db[j][t];
+            EXPECT_NEAR(ref, c[i][j], 1e-3f);
+        }
+}
+
+TEST(TDynamicMatrix, quantized_gemv_approximates_float_gemv)
+{
+    TDynamicMatrix<float> a(5, 40);
+    TDynamicVector<float> x(40), y(5), wrong(4);
+    for (size_t j = 0; j < 40; j++)
+    {
+        x[j] = float(j % 4) - 1.5f;
+        for (size_t i = 0; i < 5; i++)
+            a[i][j] = float((i + j) % 11) * 0.1f;
+    }
+
+    TQuantizedMatrix q(a);
+    multiply(q, x, y);
+    TDynamicVector<float> ref = a * x;
+    for (size_t i = 0; i < 5; i++)
+        EXPECT_NEAR(ref[i], y[i], 0.4f);
+    ASSERT_ANY_THROW(multiply(q, x, wrong));
+}
+
+TEST(TDynamicMatrix, matrix_norms_and_extrema)
+{
+    TDynamicMatrix<int> m(2, 3);
+    m[0][0] = 1; m[0][1] = -7; m[0][2] = 2;
+    m[1][0] = -3; m[1][1] = 4; m[1][2] = 7;
+
+    EXPECT_EQ(4, sum(m));
+    EXPECT_EQ(11, norm1(m));
+    EXPECT_EQ(14, normInf(m));
+    EXPECT_NEAR(std::sqrt(128.0), frobenius(m), 1e-12);
+    EXPECT_EQ(7, max(m));
+    EXPECT_EQ(-7, min(m));
+    EXPECT_EQ(std::make_pair(size_t(1), size_t(2)), argmax(m));
+}
+
+TEST(TDynamicMatrix, parallel_matrix_reductions_match_serial)
+{
+    TDynamicMatrix<double> m(700, 90);
+    for (size_t i = 0; i < m.rows(); i++)
+        for (size_t j = 0; j < m.cols(); j++)
+            m[i][j] = std::cos(double(i * 90 + j));
+    m[333][44] = 5.0;
+
+    const size_t threads = getNumThreads();
+    setNumThreads(1);
+    double s1 = sum(m, TReductionMode::Deterministic), f1 = frobenius(m), n1 = norm1(m);
+    setNumThreads(4);
+    double s4 = sum(m, TReductionMode::Deterministic), f4 = frobenius(m), n4 = norm1(m);
+    std::pair<size_t, size_t> k = argmax(m);
+    setNumThreads(threads);
+
+    EXPECT_EQ(s1, s4);
+    EXPECT_NEAR(f1, f4, 1e-9);
+    EXPECT_NEAR(n1, n4, 1e-9);
+    EXPECT_EQ(333, k.first);
+    EXPECT_EQ(44, k.second);
+}
+
+TEST(TDynamicMatrix, elementwise_map_zip_apply)
+{
+    TDynamicMatrix<int> m = makeNumberedMatrix(300, 70);
+
+    TDynamicMatrix<double> half = m.map([](int x) { return x / 2.0; });
+    EXPECT_EQ(300, half.rows());
+    EXPECT_EQ(70, half.cols());
+    EXPECT_EQ(611.5, half[122][3]);
+
+    TDynamicMatrix<int> d = m.zip(m, [](int x, int y) { return x - y; });
+    EXPECT_EQ(TDynamicMatrix<int>(300, 70), d);
+
+    m.apply([](int x) { return x % 10; });
+    EXPECT_EQ(3, m[122][3]);
+    ASSERT_ANY_THROW(m.zip(TDynamicMatrix<int>(300, 69), [](int x, int y) { return x + y; }));
+}
+
+TEST(TDynamicMatrix, thread_pool_reuses_workers_for_nested_loops)
+{
+    const size_t threads = getNumThreads();
+    setNumThreads(4);
+
+    std::mutex lock;
+    std::vector<std::thread::id> ids;
+    std::atomic<size_t> total(0);
+    for (int repeat = 0; repeat < 10; repeat++)
+        tmatrix_detail::parallelFor(0, 16, 1, [&](size_t first, size_t last)
+        {
+            for (size_t i = first; i < last; i++)
+                tmatrix_detail::parallelFor(0, 1000, 10, [&](size_t b, size_t e)
+                {
+                    total += e - b;
+                    std::lock_guard<std::mutex> guard(lock);
+                    ids.push_back(std::this_thread::get_id());
+                });
+        });
+    setNumThreads(threads);
+
+    std::sort(ids.begin(), ids.end());
+    const size_t distinct = size_t(std::unique(ids.begin(), ids.end()) - ids.begin());
+    EXPECT_EQ(10 * 16 * 1000, total.load());
+    EXPECT_LE(distinct, size_t(4));
+}
+
+TEST(TDynamicMatrix, thread_pool_propagates_exceptions_and_stays_usable)
+{
+    const size_t threads = getNumThreads();
+    setNumThreads(3);
+
+    EXPECT_THROW(tmatrix_detail::parallelFor(0, 100, 1, [](size_t first, size_t)
+    {
+        if (first == 37)
+            throw domain_error("chunk failed");
+    }), domain_error);
+
+    TDynamicMatrix<double> a = makeGeneralMatrix(40), b = makeSpdMatrix(40), c(40);
+    multiply(a, b, c);
+    setNumThreads(1);
+    TDynamicMatrix<double> ref(40);
+    multiply(a, b, ref);
+    setNumThreads(threads);
+
+    EXPECT_EQ(ref, c);
+}
+
+TEST(TDynamicMatrix, can_pin_pool_threads)
+{
+    const size_t threads = getNumThreads();
+    setNumThreads(2);
+    const bool supported = setThreadPinning(true);
+    EXPECT_EQ(supported, getThreadPinning());
+
+    TDynamicVector<int> v(100000);
+    v.apply([](int x) { return x + 1; });
+    EXPECT_EQ(100000, sum(v));
+
+    EXPECT_TRUE(setThreadPinning(false));
+    EXPECT_FALSE(getThreadPinning());
+    setNumThreads(threads);
+}
+
+TEST(TDynamicMatrix, instrumentation_counts_gemm_and_gemv)
+{
+    ASSERT_TRUE(instrumentationEnabled());
+    TDynamicMatrix<double> a(4, 3), b(3, 5), c(4, 5);
+    TDynamicVector<double> x(3), y(4);
+
+    resetInstrumentation();
+    multiply(a, b, c);
+    multiply(a, x, y);
+    multiply(a, b, c);
+    TInstrumentationSnapshot s = instrumentationSnapshot();
+
+    EXPECT_EQ(2, s[TOperation::Gemm].calls);
+    EXPECT_EQ(2 * 2 * 4 * 5 * 3, s[TOperation::Gemm].flops);
+    EXPECT_EQ(2 * (12 + 15 + 20) * sizeof(double), s[TOperation::Gemm].bytes);
+    EXPECT_EQ(1, s[TOperation::Gemv].calls);
+    EXPECT_EQ(12, s[TOperation::Gemv].elements);
+    EXPECT_EQ(0, s[TOperation::Dot].calls);
+}
+
+TEST(TDynamicMatrix, instrumentation_attributes_allocations_to_operation)
+{
+    TDynamicVector<int> v(10), w(10);
+
+    resetInstrumentation();
+    TDynamicVector<int> sum = v + w;
+    int d = v * w;
+    TInstrumentationSnapshot s = instrumentationSnapshot();
+
+    EXPECT_EQ(0, d);
+    EXPECT_EQ(1, s[TOperation::VectorAdd].calls);
+    EXPECT_EQ(10, s[TOperation::VectorAdd].flops);
+    EXPECT_EQ(1, s[TOperation::VectorAdd].allocations);
+    EXPECT_EQ(0, s[TOperation::Copy].calls);
+    EXPECT_EQ(1, s[TOperation::Dot].calls);
+    EXPECT_EQ(0, s[TOperation::Other].allocations);
+
+    TDynamicVector<int> fresh(5);
+    EXPECT_EQ(1, instrumentationSnapshot()[TOperation::Other].allocations);
+
+    std::ostringstream out;
+    out << instrumentationSnapshot();
+    EXPECT_NE(std::string::npos, out.str().find("vector_add 1 10 10"));
+}
+
+TEST(TDynamicMatrix, instrumentation_counts_matrix_arithmetic_once)
+{
+    TDynamicMatrix<int> a = makeNumberedMatrix(3, 4), b = makeNumberedMatrix(3, 4);
+
+    resetInstrumentation();
+    TDynamicMatrix<int> sum = a + b;
+    TDynamicMatrix<int> diff = a - b;
+    TDynamicMatrix<int> scaled = a * 2;
+    TInstrumentationSnapshot s = instrumentationSnapshot();
+
+    EXPECT_EQ(sum, scaled);
+    EXPECT_EQ(TDynamicMatrix<int>(3, 4), diff);
+    EXPECT_EQ(2, s[TOperation::VectorAdd].calls);
+    EXPECT_EQ(24, s[TOperation::VectorAdd].elements);
+    EXPECT_EQ(1, s[TOperation::VectorScalar].calls);
+    EXPECT_EQ(12, s[TOperation::VectorScalar].flops);
+    EXPECT_EQ(0, s[TOperation::Copy].calls);
+}
+
+TEST(TDynamicMatrix, size_limits_are_configurable)
+{
+    const size_t elements = getMaxMatrixElements();
+    setMaxMatrixElements(100);
+    ASSERT_NO_THROW(TDynamicMatrix<int> m(10, 10));
+    ASSERT_ANY_THROW(TDynamicMatrix<int> m(11, 10));
+    setMaxMatrixElements(std::numeric_limits<size_t>::max());
+    ASSERT_NO_THROW(TDynamicMatrix<int> m(11, 10));
+    setMaxMatrixElements(elements);
+    EXPECT_EQ(size_t(MAX_MATRIX_SIZE) * MAX_MATRIX_SIZE, getMaxMatrixElements());
+}
+
+TEST(TDynamicMatrix, oversized_allocation_is_reported_cleanly)
+{
+    const size_t limit = getMaxVectorSize();
+    setMaxVectorSize(std::numeric_limits<size_t>::max());
+    const TAllocationStats before = allocationStats();
+    try
+    {
+        TDynamicVector<double> v(std::numeric_limits<size_t>::max() / 4);
+        ADD_FAILURE();
+    }
+    catch (const TAllocationError& e)
+    {
+        EXPECT_EQ(std::numeric_limits<size_t>::max(), e.bytes());
+        EXPECT_NE(nullptr, e.what());
+    }
+    setMaxVectorSize(limit);
+
+    EXPECT_EQ(before.currentBytes, allocationStats().currentBytes);
+    ASSERT_ANY_THROW(TDynamicVector<int> v(MAX_VECTOR_SIZE + 1));
+}
+
+TEST(TDynamicMatrix, element_iterator_walks_rows_in_order)
+{
+    TDynamicMatrix<int> m = makeNumberedMatrix(3, 4);
+    EXPECT_EQ(12, m.end() - m.begin());
+
+    std::vector<int> seen(m.begin(), m.end());
+    EXPECT_EQ(0, seen[0]);
+    EXPECT_EQ(3, seen[3]);
+    EXPECT_EQ(10, seen[4]);
+    EXPECT_EQ(23, seen[11]);
+
+    TDynamicMatrix<int>::iterator it = m.begin() + 7;
+    EXPECT_EQ(13, *it);
+    EXPECT_EQ(12, it[-1]);
+    EXPECT_EQ(3, *(it - 4));
+    EXPECT_EQ(20, *(it + 1));
+    EXPECT_TRUE(m.begin() < it);
+    --it;
+    --it;
+    --it;
+    --it;
+    EXPECT_EQ(3, *it);
+}
+
+TEST(TDynamicMatrix, can_use_standard_algorithms_on_elements_and_rows)
+{
+    TDynamicMatrix<double> m(5, 7);
+    std::fill(m.begin(), m.end(), 2.0);
+    std::transform(m.begin(), m.end(), m.begin(), [](double x) { return x + 1.0; });
+
+    const TDynamicMatrix<double>& c = m;
+    EXPECT_EQ(105.0, std::accumulate(c.begin(), c.end(), 0.0));
+
+    TDynamicMatrix<double>::const_iterator first = m.begin();
+    EXPECT_EQ(35, std::distance(first, c.cend()));
+
+    std::reverse(m.rowsBegin(), m.rowsEnd());
+    std::sort(m.begin(), m.end());
+    EXPECT_EQ(35, std::count(c.begin(), c.end(), 3.0));
+    EXPECT_EQ(5, std::distance(c.rowsBegin(), c.rowsEnd()));
+}
+
+TEST(TDynamicMatrix, symmetric_matrix_stores_one_triangle)
+{
+    TSymmetricMatrix<int> s(4);
+    s(0, 3) = 7;
+    s(2, 1) = 5;
+    EXPECT_EQ(7, s(3, 0));
+    EXPECT_EQ(5, s.at(1, 2));
+    ASSERT_ANY_THROW(s.at(4, 0));
+
+    TDynamicMatrix<int> full = s.toMatrix();
+    EXPECT_EQ(full, full.transpose());
+    EXPECT_EQ(s, TSymmetricMatrix<int>(full));
+    ASSERT_ANY_THROW(TSymmetricMatrix<int>(TDynamicMatrix<int>(3, 4)));
+}
+
+TEST(TDynamicMatrix, symv_and_symm_match_dense_products)
+{
+    const size_t n = 300, p = 17;
+    TDynamicMatrix<double> dense = makeSpdMatrix(n);
+    TSymmetricMatrix<double> s(dense);
+    TDynamicVector<double> x(n);
+    TDynamicMatrix<double> b(n, p);
+    for (size_t i = 0; i < n; i++)
+    {
+        x[i] = std::sin(double(i));
+        for (size_t j = 0; j < p; j++)
+            b[i][j] = std::cos(double(i * p + j));
+    }
+
+    TDynamicVector<double> y = s * x, yRef = dense * x;
+    for (size_t i = 0; i < n; i++)
+        EXPECT_NEAR(yRef[i], y[i], 1e-9);
+
+    TDynamicMatrix<double> c = s * b, cRef = dense * b;
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < p; j++)
+            EXPECT_NEAR(cRef[i][j], c[i][j], 1e-9);
+}
+
+TEST(TDynamicMatrix, syrk_computes_gram_matrix)
+{
+    TDynamicMatrix<int> a = makeNumberedMatrix(150, 9);
+    TSymmetricMatrix<int> g = syrk(a);
+    EXPECT_EQ(a.transpose() * a, g.toMatrix());
+
+    TSymmetricMatrix<int> wrong(8);
+    ASSERT_ANY_THROW(syrk(a, wrong));
+}
+
+TEST(TDynamicMatrix, band_matrix_gemv_matches_dense)
+{
+    const size_t n = 200;
+    TBandMatrix<double> b(n, 2, 3);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = i > 2 ? i - 2 : 0; j <= std::min(n - 1, i + 3); j++)
+            b.at(i, j) = double(i + 1) / double(j + 2);
+    ASSERT_ANY_THROW(b.at(10, 14));
+    EXPECT_EQ(0.0, static_cast<const TBandMatrix<double>&>(b)(50, 0));
+
+    TDynamicMatrix<double> dense = b.toMatrix();
+    TDynamicVector<double> x(n);
+    for (size_t i = 0; i < n; i++)
+        x[i] = std::cos(double(i));
+    TDynamicVector<double> y = b * x, ref = dense * x;
+    for (size_t i = 0; i < n; i++)
+        EXPECT_NEAR(ref[i], y[i], 1e-12);
+    EXPECT_EQ(dense, TBandMatrix<double>(dense, 2, 3).toMatrix());
+}
+
+TEST(TDynamicMatrix, band_lu_solves_system_requiring_pivoting)
+{
+    const size_t n = 150;
+    TBandMatrix<double> a(n, 2, 1);
+    for (size_t i = 0; i < n; i++)
+    {
+        a(i, i) = (i % 3 == 0) ? 0.0 : 6.0 + double(i % 5);
+        if (i > 0)
+            a(i, i - 1) = 2.0;
+        if (i > 1)
+            a(i, i - 2) = 1.0;
+        if (i + 1 < n)
+            a(i, i + 1) = -1.0;
+    }
+    TDynamicVector<double> x0(n);
+    for (size_t i = 0; i < n; i++)
+        x0[i] = double(i % 7) - 3.0;
+    TDynamicVector<double> rhs = a * x0;
+
+    TDynamicVector<double> x = solve(a, rhs);
+    for (size_t i = 0; i < n; i++)
+        EXPECT_NEAR(x0[i], x[i], 1e-8);
+
+    TDynamicVector<size_t> pivots(n);
+    TBandMatrix<double> f(a);
+    TDynamicMatrix<double> dense = a.toMatrix();
+    TDynamicVector<size_t> densePivots(n);
+    EXPECT_EQ(lu(dense, densePivots), lu(f, pivots));
+
+    ASSERT_ANY_THROW(solve(TBandMatrix<double>(4, 1, 1), TDynamicVector<double>(4)));
+}
+
+TEST(TDynamicMatrix, thomas_solves_tridiagonal_system)
+{
+    const size_t n = 100;
+    TTridiagonalMatrix<double> t(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        t.diag(i) = 4.0;
+        t.lower(i) = -1.0;
+        t.upper(i) = -1.5;
+    }
+    TDynamicVector<double> x0(n);
+    for (size_t i = 0; i < n; i++)
+        x0[i] = std::sin(double(i));
+    TDynamicVector<double> rhs = t * x0, ref = t.toMatrix() * x0;
+    for (size_t i = 0; i < n; i++)
+        EXPECT_NEAR(ref[i], rhs[i], 1e-12);
+
+    TDynamicVector<double> x = solve(t, rhs);
+    for (size_t i = 0; i < n; i++)
+        EXPECT_NEAR(x0[i], x[i], 1e-12);
+    ASSERT_ANY_THROW(solve(TTridiagonalMatrix<double>(3), TDynamicVector<double>(3)));
+}
+
+TEST(TDynamicMatrix, batched_thomas_matches_single_solves)
+{
+    const size_t n = 40, count = 300;
+    TTridiagonalBatch<double> batch(count, n);
+    TDynamicMatrix<double> d(n, count);
+    std::vector<TTridiagonalMatrix<double>> systems;
+    for (size_t s = 0; s < count; s++)
+    {
+        TTridiagonalMatrix<double> t(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            t.diag(i) = 3.0 + double(s % 4);
+            t.lower(i) = -1.0;
+            t.upper(i) = 1.0 - double(i % 2);
+            d[i][s] = double(i + s);
+        }
+        batch.set(s, t);
+        systems.push_back(t);
+    }
+    ASSERT_THROW(batch.set(count, systems[0]), std::out_of_range);
+    ASSERT_THROW(batch.set(0, TTridiagonalMatrix<double>(n + 1)), std::length_error);
+
+    TDynamicMatrix<double> rhs(d);
+    thomasSolveInPlace(batch, d);
+    for (size_t s = 0; s < count; s += 37)
+    {
+        TDynamicVector<double> b(n);
+        for (size_t i = 0; i < n; i++)
+            b[i] = rhs[i][s];
+        TDynamicVector<double> x = solve(systems[s], b);
+        for (size_t i = 0; i < n; i++)
+            EXPECT_NEAR(x[i], d[i][s], 1e-12);
+    }
+}
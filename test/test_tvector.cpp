@@ -12,6 +12,16 @@ TEST(TDynamicVector, cant_create_too_large_vector)
   ASSERT_ANY_THROW(TDynamicVector<int> v(MAX_VECTOR_SIZE + 1));
 }
 
+TEST(TDynamicVector, cant_create_vector_from_array_with_invalid_length)
+{
+  int arr[5] = { 1, 2, 3, 4, 5 };
+  const size_t limit = getMaxVectorSize();
+  setMaxVectorSize(4);
+  EXPECT_ANY_THROW(TDynamicVector<int> v(arr, 5));
+  EXPECT_ANY_THROW(TDynamicVector<int> v(arr, 0));
+  setMaxVectorSize(limit);
+}
+
 TEST(TDynamicVector, throws_when_create_vector_with_negative_length)
 {
   ASSERT_ANY_THROW(TDynamicVector<int> v(-5));
@@ -146,7 +156,7 @@ TEST(TDynamicVector, vectors_with_different_size_are_not_equal)
 		v1[i] = i;
 
 	for (size_t i = 0; i < 10; i++)
-		v1[i] = i + 20;
+		v2[i] = i + 20;
 	
 
 	ASSERT_EQ(v1 == v2, false);
@@ -269,3 +279,374 @@ TEST(TDynamicVector, cant_multiply_vectors_with_not_equal_size)
 	ASSERT_ANY_THROW(v1 * v2);
 }
 
+
+static void laplacian(const TDynamicVector<double>& x, TDynamicVector<double>& y)
+{
+	const size_t n = x.size();
+	for (size_t i = 0; i < n; i++)
+	{
+		y[i] = 2.0 * x[i];
+		if (i > 0)
+			y[i] -= x[i - 1];
+		if (i + 1 < n)
+			y[i] -= x[i + 1];
+	}
+}
+
+TEST(TDynamicVector, conjugate_gradient_solves_operator_system)
+{
+	const size_t n = 200;
+	TDynamicVector<double> b(n), x(n), ax(n);
+	for (size_t i = 0; i < n; i++)
+		b[i] = double(i % 5) - 2.0;
+
+	TIterativeOptions<double> options;
+	options.maxIterations = 500;
+	TIterativeResult<double> res = conjugateGradient(laplacian, b, x, options);
+
+	EXPECT_TRUE(res.converged);
+	EXPECT_LE(res.iterations, n);
+	laplacian(x, ax);
+	for (size_t i = 0; i < n; i++)
+		EXPECT_NEAR(b[i], ax[i], 1e-8);
+}
+
+TEST(TDynamicVector, conjugate_gradient_accepts_matrix)
+{
+	const size_t n = 30;
+	TDynamicMatrix<double> a(n);
+	for (size_t i = 0; i < n; i++)
+	{
+		a[i][i] = 4;
+		if (i > 0)
+			a[i][i - 1] = a[i - 1][i] = 1;
+	}
+	TDynamicVector<double> x0(n), b(n), x(n);
+	for (size_t i = 0; i < n; i++)
+		x0[i] = double(i);
+	b = a * x0;
+
+	EXPECT_TRUE(conjugateGradient(a, b, x).converged);
+	for (size_t i = 0; i < n; i++)
+		EXPECT_NEAR(x0[i], x[i], 1e-8);
+}
+
+TEST(TDynamicVector, iterative_solver_callback_can_stop_iterations)
+{
+	const size_t n = 100;
+	TDynamicVector<double> b(n), x(n);
+	for (size_t i = 0; i < n; i++)
+		b[i] = 1.0;
+
+	size_t calls = 0;
+	TIterativeResult<double> res = conjugateGradient(laplacian, b, x, TIterativeOptions<double>(),
+		[&](size_t iteration, double) { calls = iteration; return iteration < 3; });
+
+	EXPECT_EQ(3, res.iterations);
+	EXPECT_EQ(3, calls);
+	EXPECT_FALSE(res.converged);
+}
+
+TEST(TDynamicVector, bicgstab_solves_nonsymmetric_system)
+{
+	const size_t n = 80;
+	TDynamicMatrix<double> a(n);
+	for (size_t i = 0; i < n; i++)
+	{
+		a[i][i] = 5;
+		if (i > 0)
+			a[i][i - 1] = -2;
+		if (i + 1 < n)
+			a[i][i + 1] = 1;
+	}
+	TDynamicVector<double> x0(n), b(n), x(n);
+	for (size_t i = 0; i < n; i++)
+		x0[i] = double(i % 7) - 3.0;
+	b = a * x0;
+
+	TIterativeResult<double> res = biCGStab(a, b, x);
+	EXPECT_TRUE(res.converged);
+	for (size_t i = 0; i < n; i++)
+		EXPECT_NEAR(x0[i], x[i], 1e-8);
+}
+
+TEST(TDynamicVector, cow_copy_shares_memory_until_write)
+{
+	TDynamicVector<int> src(5);
+	src[2] = 7;
+	TCowVector<int> v(src);
+	TCowVector<int> c(v);
+
+	EXPECT_TRUE(v.isShared());
+	EXPECT_EQ(v.vector().data(), c.vector().data());
+	EXPECT_EQ(7, c[2]);
+
+	c[2] = 8;
+	EXPECT_FALSE(v.isShared());
+	EXPECT_NE(v.vector().data(), c.vector().data());
+	EXPECT_EQ(7, v[2]);
+	EXPECT_EQ(8, c[2]);
+}
+
+TEST(TDynamicVector, cow_copy_does_not_see_writes_through_earlier_reference)
+{
+	TCowVector<int> v(5);
+	int& r = v[0];
+	TCowVector<int> c(v);
+	r = 9;
+
+	EXPECT_FALSE(v.isShared());
+	EXPECT_EQ(9, v.vector()[0]);
+	EXPECT_EQ(0, c.vector()[0]);
+
+	TCowVector<int> d(c);
+	EXPECT_TRUE(c.isShared());
+}
+
+TEST(TDynamicVector, cow_vector_stays_valid_after_move)
+{
+	TDynamicVector<int> src(5);
+	src[1] = 3;
+	TCowVector<int> v(src);
+	TCowVector<int> m(std::move(v));
+	TCowVector<int> a(2);
+	a = std::move(m);
+
+	EXPECT_EQ(3, v.useCount());
+	EXPECT_EQ(5, v.size());
+	EXPECT_EQ(3, v.vector()[1]);
+	EXPECT_EQ(3, m.vector()[1]);
+	EXPECT_EQ(3, a.vector()[1]);
+}
+
+TEST(TDynamicVector, cow_const_access_does_not_detach)
+{
+	TCowVector<int> v(TDynamicVector<int>(4));
+	const TCowVector<int> c(v);
+	EXPECT_EQ(0, c[1] + c.at(3));
+	EXPECT_EQ(2, v.useCount());
+	EXPECT_TRUE(c == v);
+	ASSERT_ANY_THROW(c.at(4));
+}
+
+TEST(TDynamicVector, cow_copies_detach_independently_across_threads)
+{
+	TCowVector<int> v(1000);
+	std::vector<TCowVector<int>> copies(4, v);
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < copies.size(); t++)
+		threads.emplace_back([&copies, t]()
+		{
+			for (size_t i = 0; i < copies[t].size(); i++)
+				copies[t][i] = int(t);
+		});
+	for (size_t t = 0; t < threads.size(); t++)
+		threads[t].join();
+
+	EXPECT_EQ(1, v.useCount());
+	EXPECT_EQ(0, v[999]);
+	for (size_t t = 0; t < copies.size(); t++)
+		EXPECT_EQ(int(t), copies[t][999]);
+}
+
+TEST(TDynamicVector, copy_of_trivial_elements_is_equal_and_independent)
+{
+	TDynamicVector<double> v(1000);
+	for (size_t i = 0; i < v.size(); i++)
+		v[i] = 0.5 * i;
+	TDynamicVector<double> c(v), a(3);
+	a = v;
+
+	EXPECT_EQ(v, c);
+	EXPECT_EQ(v, a);
+	c[999] = -1;
+	EXPECT_EQ(499.5, v[999]);
+	EXPECT_NE(v, c);
+}
+
+TEST(TDynamicVector, floating_point_equality_is_not_bitwise)
+{
+	TDynamicVector<double> v(2), w(2);
+	v[0] = 0.0;
+	w[0] = -0.0;
+	EXPECT_EQ(v, w);
+
+	v[1] = std::numeric_limits<double>::quiet_NaN();
+	w[1] = v[1];
+	EXPECT_NE(v, w);
+}
+
+TEST(TDynamicVector, integer_equality_detects_difference_in_last_element)
+{
+	TDynamicVector<long long> v(1001), w(1001);
+	EXPECT_EQ(v, w);
+	w[1000] = 1;
+	EXPECT_NE(v, w);
+}
+
+TEST(TDynamicVector, reductions_match_scalar_loops)
+{
+	TDynamicVector<int> v(1003);
+	for (size_t i = 0; i < v.size(); i++)
+		v[i] = int(i % 17) - 8;
+	v[500] = 40;
+	v[700] = -50;
+
+	int s = 0, s1 = 0;
+	for (size_t i = 0; i < v.size(); i++)
+	{
+		s += v[i];
+		s1 += std::abs(v[i]);
+	}
+	EXPECT_EQ(s, sum(v));
+	EXPECT_EQ(s1, norm1(v));
+	EXPECT_EQ(50, normInf(v));
+	EXPECT_EQ(40, max(v));
+	EXPECT_EQ(-50, min(v));
+	EXPECT_EQ(500, argmax(v));
+}
+
+TEST(TDynamicVector, argmax_returns_first_of_equal_maxima)
+{
+	TDynamicVector<double> v(100000);
+	v[70000] = 3.0;
+	v[3] = 3.0;
+	v[99999] = 3.0;
+	EXPECT_EQ(3, argmax(v));
+}
+
+TEST(TDynamicVector, norm2_of_large_vector)
+{
+	TDynamicVector<double> v(100000);
+	for (size_t i = 0; i < v.size(); i++)
+		v[i] = (i % 2 == 0) ? 3.0 : -4.0;
+	EXPECT_NEAR(std::sqrt(12.5 * v.size()), norm2(v), 1e-9);
+}
+
+TEST(TDynamicVector, deterministic_sum_does_not_depend_on_thread_count)
+{
+	TDynamicVector<double> v(300001);
+	for (size_t i = 0; i < v.size(); i++)
+		v[i] = std::sin(double(i)) * std::pow(10.0, double(i % 13) - 6.0);
+
+	const size_t threads = getNumThreads();
+	setNumThreads(1);
+	double s1 = sum(v, TReductionMode::Deterministic);
+	setNumThreads(7);
+	double s7 = sum(v, TReductionMode::Deterministic);
+	setNumThreads(threads);
+
+	EXPECT_EQ(s1, s7);
+	EXPECT_NEAR(s1, sum(v), 1e-6);
+}
+
+TEST(TDynamicVector, map_can_change_element_type)
+{
+	TDynamicVector<int> v(5);
+	for (size_t i = 0; i < v.size(); i++)
+		v[i] = int(i) - 2;
+
+	TDynamicVector<double> r = v.map([](int x) { return 0.5 * x; });
+	EXPECT_EQ(-1.0, r[0]);
+	EXPECT_EQ(1.0, r[4]);
+	EXPECT_EQ(-2, v[0]);
+}
+
+TEST(TDynamicVector, zip_combines_large_vectors_elementwise)
+{
+	const size_t n = 100003;
+	TDynamicVector<float> a(n), b(n);
+	for (size_t i = 0; i < n; i++)
+	{
+		a[i] = float(i % 100);
+		b[i] = float(i % 7);
+	}
+	TDynamicVector<float> c = a.zip(b, [](float x, float y) { return x * y + 1.0f; });
+	for (size_t i = 0; i < n; i += 997)
+		EXPECT_EQ(a[i] * b[i] + 1.0f, c[i]);
+	ASSERT_ANY_THROW(a.zip(TDynamicVector<float>(3), [](float x, float y) { return x + y; }));
+}
+
+TEST(TDynamicVector, apply_modifies_vector_in_place)
+{
+	const size_t n = 50000;
+	TDynamicVector<double> v(n);
+	for (size_t i = 0; i < n; i++)
+		v[i] = double(i) - 25000.0;
+	v.apply([](double x) { return x > 0.0 ? x : 0.0; });
+	EXPECT_EQ(0.0, v[0]);
+	EXPECT_EQ(0.0, v[25000]);
+	EXPECT_EQ(24999.0, v[n - 1]);
+}
+
+TEST(TDynamicVector, allocation_stats_track_current_and_peak_bytes)
+{
+	const TAllocationStats before = allocationStats();
+	resetPeakAllocation();
+	{
+		TDynamicVector<double> v(1000);
+		TDynamicVector<double> w(v);
+		const TAllocationStats during = allocationStats();
+		EXPECT_EQ(before.currentBytes + 2 * 1000 * sizeof(double), during.currentBytes);
+		EXPECT_EQ(before.liveBuffers + 2, during.liveBuffers);
+		ASSERT_FALSE(during.largest.empty());
+		EXPECT_EQ(1000 * sizeof(double), during.largest[0]);
+	}
+	const TAllocationStats after = allocationStats();
+	EXPECT_EQ(before.currentBytes, after.currentBytes);
+	EXPECT_EQ(before.liveBuffers, after.liveBuffers);
+	EXPECT_EQ(before.currentBytes + 2 * 1000 * sizeof(double), after.peakBytes);
+}
+
+namespace
+{
+	size_t hookAllocated = 0, hookReleased = 0;
+
+	void countingHook(size_t bytes, bool allocated)
+	{
+		(allocated ? hookAllocated : hookReleased) += bytes;
+	}
+}
+
+TEST(TDynamicVector, allocation_hook_sees_every_buffer)
+{
+	hookAllocated = hookReleased = 0;
+	TAllocationHook previous = setAllocationHook(countingHook);
+	{
+		TDynamicVector<int> v(10), w(20);
+		v = w;
+	}
+	setAllocationHook(previous);
+
+	EXPECT_EQ((10 + 20 + 20) * sizeof(int), hookAllocated);
+	EXPECT_EQ(hookAllocated, hookReleased);
+}
+
+TEST(TDynamicVector, allocation_free_scope_rejects_allocations)
+{
+	TDynamicVector<int> v(100), w(100), r(100);
+	{
+		TNoAllocationScope scope;
+		r = v;
+		EXPECT_EQ(0, v * w);
+		ASSERT_ANY_THROW(v + w);
+		ASSERT_ANY_THROW(TDynamicVector<int> tmp(3));
+	}
+	ASSERT_NO_THROW(v + w);
+}
+
+TEST(TDynamicVector, works_with_standard_algorithms)
+{
+	TDynamicVector<int> v(6), w(6);
+	std::iota(v.begin(), v.end(), 1);
+	std::transform(v.begin(), v.end(), w.begin(), [](int x) { return x * x; });
+
+	EXPECT_EQ(21, std::accumulate(v.cbegin(), v.cend(), 0));
+	EXPECT_EQ(36, w[5]);
+	EXPECT_EQ(6, std::distance(w.begin(), w.end()));
+
+	int total = 0;
+	for (int x : w)
+		total += x;
+	EXPECT_EQ(91, total);
+}